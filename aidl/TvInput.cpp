@@ -16,10 +16,13 @@
 
 #define LOG_TAG "android.hardware.tv.input-service"
 
+#include <stdio.h>
+#include <string.h>
 #include <utils/Log.h>
 #include <cutils/properties.h>
 
 #include "TvInput.h"
+#include "TvTrace.h"
 #include "tvcmd.h"
 #include <hardware/hardware.h>
 
@@ -29,9 +32,6 @@ namespace hardware {
 namespace tv {
 namespace input {
 
-shared_ptr<ITvInputCallback> TvInput::mCallback = nullptr;
-
-
 TvInput::TvInput() {
     ALOGI("TvInput Hal Initialization starts");
 
@@ -40,6 +40,18 @@ TvInput::TvInput() {
     tv_input_device_open(&mModule, "default", reinterpret_cast<hw_device_t**>(&mDevice));
 
     mCallbackOps.notify = &TvInput::notify;
+
+    mMessagePipeline = std::make_unique<TvMessagePipeline>(
+            [this](int32_t deviceId, int32_t streamId, TvMessageEventType type) {
+                return mTvMessageEventEnabled.isEnabled(deviceId, streamId, type);
+            },
+            [this](const TvMessageEvent& event) {
+                shared_ptr<ITvInputCallback> callback = this->callback();
+                if (callback != nullptr) {
+                    callback->notifyTvMessageEvent(event);
+                }
+            });
+    tv_input_set_message_callback(mDevice, &TvInput::onTvMessage, this);
 }
 
 void TvInput::init() {
@@ -61,11 +73,12 @@ void TvInput::init() {
 
 ::ndk::ScopedAStatus TvInput::setCallback(const shared_ptr<ITvInputCallback>& in_callback) {
     ALOGV("%s", __FUNCTION__);
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::SET_CALLBACK);
 
-    mCallback = in_callback;
+    std::atomic_store(&mCallback, in_callback);
 
-    if (mCallback != nullptr) {
-        mDevice->initialize(mDevice, &mCallbackOps, nullptr);
+    if (in_callback != nullptr) {
+        mDevice->initialize(mDevice, &mCallbackOps, this);
     }
 
     return ::ndk::ScopedAStatus::ok();
@@ -74,14 +87,19 @@ void TvInput::init() {
 ::ndk::ScopedAStatus TvInput::setTvMessageEnabled(int32_t deviceId, int32_t streamId,
                                                   TvMessageEventType in_type, bool enabled) {
     ALOGV("%s deviceId:%d streamId:%d enabled:%d", __FUNCTION__, deviceId, streamId, enabled);
-    //todo
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::SET_TV_MESSAGE_ENABLED);
 
-    if (mStreamConfigs.count(deviceId) == 0) {
+    if (!isKnownDevice(deviceId)) {
         ALOGW("Device with id %d isn't available", deviceId);
+        scope.setFailed(true);
         return ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_INVALID_ARGUMENTS);
     }
 
-    mTvMessageEventEnabled[deviceId][streamId][in_type] = enabled;
+    if (!mTvMessageEventEnabled.set(deviceId, streamId, in_type, enabled)) {
+        ALOGW("Stream %d of device %d can't carry TvMessages", streamId, deviceId);
+        scope.setFailed(true);
+        return ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_INVALID_ARGUMENTS);
+    }
     return ::ndk::ScopedAStatus::ok();
 }
 
@@ -89,40 +107,49 @@ void TvInput::init() {
         MQDescriptor<int8_t, SynchronizedReadWrite>* out_queue, int32_t in_deviceId,
         int32_t in_streamId) {
     ALOGV("%s deviceId:%d streamId:%d", __FUNCTION__, in_deviceId, in_streamId);
-    //todo
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::GET_TV_MESSAGE_QUEUE_DESC);
 
-    if (mStreamConfigs.count(in_deviceId) == 0) {
+    if (!isKnownDevice(in_deviceId)) {
         ALOGW("Device with id %d isn't available", in_deviceId);
+        scope.setFailed(true);
         return ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_INVALID_ARGUMENTS);
     }
+    if (!mMessagePipeline->getQueueDesc(in_deviceId, in_streamId, out_queue)) {
+        scope.setFailed(true);
+        return ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_NO_RESOURCE);
+    }
     return ::ndk::ScopedAStatus::ok();
 }
 
 ::ndk::ScopedAStatus TvInput::getStreamConfigurations(int32_t in_deviceId,
                                                       vector<TvStreamConfig>* _aidl_return) {
     ALOGV("%s deviceId:%d", __FUNCTION__, in_deviceId);
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::GET_STREAM_CONFIGURATIONS);
+
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        auto it = mStreamConfigCache.find(in_deviceId);
+        if (it != mStreamConfigCache.end()) {
+            *_aidl_return = it->second;
+            return ::ndk::ScopedAStatus::ok();
+        }
+        generation = mStreamConfigGeneration[in_deviceId];
+    }
 
-    int32_t configCount = 0;
-    const tv_stream_config_t* configs = nullptr;
-    int ret = mDevice->get_stream_configurations(mDevice, in_deviceId, &configCount, &configs);
+    // no event for this device yet, fill the cache on first use
     vector<TvStreamConfig> tvStreamConfigs;
+    int ret = queryStreamConfigurations(in_deviceId, &tvStreamConfigs);
     if (ret == 0) {
-        tvStreamConfigs.resize(getSupportedConfigCount(configCount, configs));
-        int32_t pos = 0;
-        for (int32_t i = 0; i < configCount; ++i) {
-            if (isSupportedStreamType(configs[i].type)) {
-                tvStreamConfigs[pos].streamId = configs[i].stream_id;
-                tvStreamConfigs[pos].maxVideoWidth = configs[i].max_video_width;
-                tvStreamConfigs[pos].maxVideoHeight = configs[i].max_video_height;
-                _aidl_return->push_back(tvStreamConfigs[pos]);
-                ALOGD("%s streamId:%d width:%d, height:%d", __FUNCTION__,
-                     configs[i].stream_id, configs[i].max_video_width, configs[i].max_video_height);
-
-                ++pos;
-            }
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        *_aidl_return = tvStreamConfigs;
+        // an event while querying wins, the list may already be stale
+        if (mStreamConfigGeneration[in_deviceId] == generation) {
+            mStreamConfigCache.emplace(in_deviceId, std::move(tvStreamConfigs));
         }
         return ::ndk::ScopedAStatus::ok();
     } else if (ret == -EINVAL) {
+        scope.setFailed(true);
         return ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_INVALID_ARGUMENTS);
     }
     return ::ndk::ScopedAStatus::ok();
@@ -131,6 +158,8 @@ void TvInput::init() {
 ::ndk::ScopedAStatus TvInput::openStream(int32_t in_deviceId, int32_t in_streamId,
                                          ::aidl::android::hardware::common::NativeHandle* _aidl_return) {
     ALOGV("%s deviceId:%d, streamId:%d", __FUNCTION__, in_deviceId, in_streamId);
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::OPEN_STREAM);
+    TV_TRACE_CALL();
 
     tv_stream_t stream;
     stream.stream_id = in_streamId;
@@ -155,15 +184,19 @@ void TvInput::init() {
         }
     }
 
+    scope.setFailed(!res.isOk());
     return res;
 }
 
 ::ndk::ScopedAStatus TvInput::closeStream(int32_t in_deviceId, int32_t in_streamId) {
     ALOGV("%s deviceId:%d, streamId:%d", __FUNCTION__, in_deviceId, in_streamId);
+    TvMethodStats::Scope scope(mMethodStats, TvMethod::CLOSE_STREAM);
+    TV_TRACE_CALL();
 
     int ret = mDevice->close_stream(mDevice, in_deviceId, in_streamId);
     ::ndk::ScopedAStatus res = ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_UNKNOWN);
     if (ret == 0) {
+        mMessagePipeline->removeQueue(in_deviceId, in_streamId);
         res = ::ndk::ScopedAStatus::ok();
     } else if (ret == -EBUSY) {
         res = ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_NO_RESOURCE);
@@ -173,95 +206,188 @@ void TvInput::init() {
         res = ::ndk::ScopedAStatus::fromServiceSpecificError(STATUS_INVALID_ARGUMENTS);
     }
 
+    scope.setFailed(!res.isOk());
     return res;
 }
 
+binder_status_t TvInput::dump(int fd, const char** args, uint32_t numArgs) {
+    bool reset = false;
+    for (uint32_t i = 0; i < numArgs; i++) {
+        if (strcmp(args[i], "--reset") == 0) {
+            reset = true;
+        }
+    }
+
+    dprintf(fd, "callback %s\n", callback() != nullptr ? "set" : "not set");
+    {
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        dprintf(fd, "stream config cache, %zu devices:\n", mStreamConfigCache.size());
+        for (const auto& entry : mStreamConfigCache) {
+            dprintf(fd, "  device %d:", entry.first);
+            for (const TvStreamConfig& config : entry.second) {
+                dprintf(fd, " %d(%dx%d)", config.streamId, config.maxVideoWidth,
+                        config.maxVideoHeight);
+            }
+            dprintf(fd, "\n");
+        }
+    }
+    mMessagePipeline->dump(fd);
+    mMethodStats.dump(fd);
+    if (reset) {
+        mMethodStats.reset();
+    }
+
+    dprintf(fd, "\nlegacy HAL:\n");
+    tv_input_dump(mDevice, fd, reset);
+    if (reset) {
+        dprintf(fd, "counters reset\n");
+    }
+    return STATUS_OK;
+}
+
 // static
 void TvInput::notify(struct tv_input_device* __unused, tv_input_event_t* event,
-                     void* optionalStatus) {
-    if (mCallback != nullptr && event != nullptr) {
+                     void* data) {
+    TvInput* tvInput = static_cast<TvInput*>(data);
+    if (tvInput != nullptr && event != nullptr) {
+        if (event->type == TV_INPUT_EVENT_STREAM_CONFIGURATIONS_CHANGED ||
+            event->type == TV_INPUT_EVENT_DEVICE_AVAILABLE) {
+            tvInput->updateStreamConfigCache(event->device_info.device_id, true);
+        } else if (event->type == TV_INPUT_EVENT_DEVICE_UNAVAILABLE) {
+            tvInput->updateStreamConfigCache(event->device_info.device_id, false);
+        }
+    }
+
+    shared_ptr<ITvInputCallback> callback = tvInput != nullptr ? tvInput->callback() : nullptr;
+    if (callback != nullptr && event != nullptr) {
         // Capturing is no longer supported.
         if (event->type >= TV_INPUT_EVENT_CAPTURE_SUCCEEDED) {
             return;
         }
-        TvInputEvent tvInputEvent;
+        // everything but the event type is fixed per source
+        TvInputEvent tvInputEvent = eventTemplate(event->device_info.device_id);
         tvInputEvent.type = static_cast<TvInputEventType>(event->type);
-        tvInputEvent.deviceInfo.deviceId = event->device_info.device_id;
-        tvInputEvent.deviceInfo.type = static_cast<TvInputType>(
-                event->device_info.type);
-        tvInputEvent.deviceInfo.portId = event->device_info.hdmi.port_id;
-        // aidl audio type is of audio_devices_t.
-        // TvInputHardwareInfo {id=19, type=2, audio_type=13, audio_addr=, cable_connection_status=0}
-        // TvInputHardwareInfo {id=19, type=2, audio_type=-2147467264, audio_addr=, cable_connection_status=0}
-        tvInputEvent.deviceInfo.audioDevice.type.type =
-                static_cast<AudioDeviceType>(event->device_info.audio_type);
-        CableConnectionStatus connectionStatus = CableConnectionStatus::UNKNOWN;
-        if (optionalStatus != nullptr &&
-            ((event->type == TV_INPUT_EVENT_STREAM_CONFIGURATIONS_CHANGED) ||
-             (event->type == TV_INPUT_EVENT_DEVICE_AVAILABLE))) {
-            int newStatus = *reinterpret_cast<int*>(optionalStatus);
-            if (newStatus <= static_cast<int>(CableConnectionStatus::DISCONNECTED) &&
-                newStatus >= static_cast<int>(CableConnectionStatus::UNKNOWN)) {
-                connectionStatus = static_cast<CableConnectionStatus>(newStatus);
-            }
+
+        callback->notify(tvInputEvent);
+    }
+}
+
+// static
+void TvInput::onTvMessage(void* data, int deviceId, int streamId, int type,
+                          const int32_t* payload, size_t size) {
+    TvInput* tvInput = static_cast<TvInput*>(data);
+    tvInput->mMessagePipeline->post(deviceId, streamId, static_cast<TvMessageEventType>(type),
+                                    payload, size);
+}
+
+int TvInput::queryStreamConfigurations(int32_t deviceId, vector<TvStreamConfig>* configs) {
+    int32_t configCount = 0;
+    const tv_stream_config_t* halConfigs = nullptr;
+    int ret = mDevice->get_stream_configurations(mDevice, deviceId, &configCount, &halConfigs);
+    if (ret != 0) {
+        return ret;
+    }
+
+    configs->clear();
+    configs->reserve(configCount);
+    for (int32_t i = 0; i < configCount; ++i) {
+        if (isSupportedStreamType(halConfigs[i].type)) {
+            TvStreamConfig config;
+            config.streamId = halConfigs[i].stream_id;
+            config.maxVideoWidth = halConfigs[i].max_video_width;
+            config.maxVideoHeight = halConfigs[i].max_video_height;
+            configs->push_back(config);
+            ALOGD("%s streamId:%d width:%d, height:%d", __FUNCTION__,
+                 halConfigs[i].stream_id, halConfigs[i].max_video_width,
+                 halConfigs[i].max_video_height);
         }
-        tvInputEvent.deviceInfo.cableConnectionStatus = connectionStatus;
-        // TODO: Ensure the legacy audio type code is the same once audio HAL default
-        // implementation is ready.
-        switch (event->device_info.device_id) {
-            case SOURCE_TV:
-            case SOURCE_DTV:
-            case SOURCE_ADTV:
-            case SOURCE_DTVKIT:
-            case SOURCE_DTVKIT_PIP:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_TV_TUNER;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = "";
-                break;
-            case SOURCE_AV1:
-            case SOURCE_AV2:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_DEVICE;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = AudioDeviceDescription::CONNECTION_ANALOG;
-                break;
-            case SOURCE_HDMI1:
-            case SOURCE_HDMI2:
-            case SOURCE_HDMI3:
-            case SOURCE_HDMI4:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_DEVICE;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = AudioDeviceDescription::CONNECTION_HDMI;
-                break;
-            case SOURCE_SPDIF:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_DEVICE;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = AudioDeviceDescription::CONNECTION_SPDIF;
-                break;
-            case SOURCE_AUX:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_DEVICE;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = AudioDeviceDescription::CONNECTION_ANALOG;
-                break;
-            case SOURCE_ARC:
-                tvInputEvent.deviceInfo.audioDevice.type.type = AudioDeviceType::IN_DEVICE;
-                tvInputEvent.deviceInfo.audioDevice.type.connection = AudioDeviceDescription::CONNECTION_HDMI_ARC;
-                break;
-            default:
-                break;
+    }
+    return 0;
+}
+
+// a device the legacy HAL reports configurations for, cached or not
+bool TvInput::isKnownDevice(int32_t deviceId) {
+    {
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        if (mStreamConfigCache.count(deviceId) != 0) {
+            return true;
         }
+    }
+    int32_t configCount = 0;
+    const tv_stream_config_t* halConfigs = nullptr;
+    return mDevice->get_stream_configurations(mDevice, deviceId, &configCount, &halConfigs) == 0;
+}
 
-        // todo the address from hal is always null now.
-        // vInputEvent.deviceInfo.audioDevice.address.id = ?
+void TvInput::updateStreamConfigCache(int32_t deviceId, bool available) {
+    vector<TvStreamConfig> configs;
+    if (available && queryStreamConfigurations(deviceId, &configs) == 0) {
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        mStreamConfigGeneration[deviceId]++;
+        mStreamConfigCache[deviceId] = std::move(configs);
+    } else {
+        std::lock_guard<std::mutex> lock(mStreamConfigLock);
+        mStreamConfigGeneration[deviceId]++;
+        mStreamConfigCache.erase(deviceId);
+    }
+}
 
-        mCallback->notify(tvInputEvent);
+// static
+TvInputEvent TvInput::makeEventTemplate(int32_t deviceId, const tv_source_traits_t& traits) {
+    TvInputEvent tvInputEvent;
+    tvInputEvent.deviceInfo.deviceId = deviceId;
+    tvInputEvent.deviceInfo.type = static_cast<TvInputType>(traits.type);
+    tvInputEvent.deviceInfo.portId = traits.hdmi_port;
+    // the legacy HAL has no cable status
+    tvInputEvent.deviceInfo.cableConnectionStatus = CableConnectionStatus::UNKNOWN;
+    // TODO: Ensure the legacy audio type code is the same once audio HAL default
+    // implementation is ready.
+    AudioDeviceDescription& audio = tvInputEvent.deviceInfo.audioDevice.type;
+    switch (traits.audio_connection) {
+        case TV_AUDIO_CONNECTION_TUNER:
+            audio.type = AudioDeviceType::IN_TV_TUNER;
+            audio.connection = "";
+            break;
+        case TV_AUDIO_CONNECTION_ANALOG:
+            audio.type = AudioDeviceType::IN_DEVICE;
+            audio.connection = AudioDeviceDescription::CONNECTION_ANALOG;
+            break;
+        case TV_AUDIO_CONNECTION_HDMI:
+            audio.type = AudioDeviceType::IN_DEVICE;
+            audio.connection = AudioDeviceDescription::CONNECTION_HDMI;
+            break;
+        case TV_AUDIO_CONNECTION_HDMI_ARC:
+            audio.type = AudioDeviceType::IN_DEVICE;
+            audio.connection = AudioDeviceDescription::CONNECTION_HDMI_ARC;
+            break;
+        case TV_AUDIO_CONNECTION_SPDIF:
+            audio.type = AudioDeviceType::IN_DEVICE;
+            audio.connection = AudioDeviceDescription::CONNECTION_SPDIF;
+            break;
+        default:
+            audio.type = static_cast<AudioDeviceType>(traits.audio_type);
+            break;
     }
+    // todo the address from hal is always null now.
+    // tvInputEvent.deviceInfo.audioDevice.address.id = ?
+    return tvInputEvent;
 }
 
 // static
-uint32_t TvInput::getSupportedConfigCount(uint32_t configCount,
-        const tv_stream_config_t* configs) {
-    uint32_t supportedConfigCount = 0;
-    for (uint32_t i = 0; i < configCount; ++i) {
-        if (isSupportedStreamType(configs[i].type)) {
-            supportedConfigCount++;
+TvInputEvent TvInput::eventTemplate(int32_t deviceId) {
+    static const vector<TvInputEvent> templates = [] {
+        vector<TvInputEvent> events;
+        events.reserve(TV_SOURCE_TRAITS_COUNT);
+        for (const tv_source_traits_t& traits : kTvSourceTraits) {
+            events.push_back(makeEventTemplate(traits.source, traits));
         }
+        return events;
+    }();
+
+    int slot = tvSourceSlot(deviceId);
+    if (slot < 0) {
+        return makeEventTemplate(deviceId, kTvSourceTraitsInvalid);
     }
-    return supportedConfigCount;
+    return templates[slot];
 }
 
 // static
@@ -23,8 +23,13 @@
 #include <aidl/android/media/audio/common/AudioDeviceDescription.h>
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "TvInputDeviceInfoWrapper.h"
+#include "TvMessageEnableTable.h"
+#include "TvMessagePipeline.h"
+#include "TvMethodStats.h"
 #include "TvStreamConfigWrapper.h"
 
 #include "tv_input.h"
@@ -44,9 +49,6 @@ namespace hardware {
 namespace tv {
 namespace input {
 
-using TvMessageEnabledMap = std::unordered_map<
-        int32_t, std::unordered_map<int32_t, std::unordered_map<TvMessageEventType, bool>>>;
-
 class TvInput : public BnTvInput {
   public:
     TvInput();
@@ -62,19 +64,36 @@ class TvInput : public BnTvInput {
     ::ndk::ScopedAStatus openStream(int32_t in_deviceId, int32_t in_streamId,
                                     ::aidl::android::hardware::common::NativeHandle* _aidl_return) override;
     ::ndk::ScopedAStatus closeStream(int32_t in_deviceId, int32_t in_streamId) override;
+    // dumpsys android.hardware.tv.input.ITvInput/default [--reset]
+    binder_status_t dump(int fd, const char** args, uint32_t numArgs) override;
     void init();
 
   private:
     static void notify(struct tv_input_device* __unused, tv_input_event_t* event,
-            void* __unused);
-    static uint32_t getSupportedConfigCount(uint32_t configCount,
-            const tv_stream_config_t* configs);
+            void* data);
     static bool isSupportedStreamType(int type);
-
-    static shared_ptr<ITvInputCallback> mCallback;
+    static TvInputEvent makeEventTemplate(int32_t deviceId, const tv_source_traits_t& traits);
+    static TvInputEvent eventTemplate(int32_t deviceId);
+    int queryStreamConfigurations(int32_t deviceId, vector<TvStreamConfig>* configs);
+    bool isKnownDevice(int32_t deviceId);
+    void updateStreamConfigCache(int32_t deviceId, bool available);
+    static void onTvMessage(void* data, int deviceId, int streamId, int type,
+            const int32_t* payload, size_t size);
+
+    // set on a binder thread, read by the HAL event and message threads
+    shared_ptr<ITvInputCallback> callback() const { return std::atomic_load(&mCallback); }
+
+    shared_ptr<ITvInputCallback> mCallback;
     map<int32_t, shared_ptr<TvInputDeviceInfoWrapper>> mDeviceInfos;
     map<int32_t, map<int32_t, shared_ptr<TvStreamConfigWrapper>>> mStreamConfigs;
-    TvMessageEnabledMap mTvMessageEventEnabled;
+    TvMessageEnableTable mTvMessageEventEnabled;
+    std::unique_ptr<TvMessagePipeline> mMessagePipeline;
+    // only touched on events and misses, queries copy out under the lock
+    std::mutex mStreamConfigLock;
+    map<int32_t, vector<TvStreamConfig>> mStreamConfigCache;
+    // bumped by every event, a miss only fills the cache if none came in between
+    map<int32_t, uint32_t> mStreamConfigGeneration;
+    TvMethodStats mMethodStats;
 
     hw_module_t mModule;
 
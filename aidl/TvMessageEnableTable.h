@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <aidl/android/hardware/tv/input/TvMessageEventType.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace tv {
+namespace input {
+
+// One word per (device, stream), one bit per TvMessageEventType.  Writers
+// are binder threads calling setTvMessageEnabled, the reader is the message
+// producer which only needs a single load per message.
+class TvMessageEnableTable {
+  public:
+    // device ids go up to SOURCE_DTVKIT_PIP (119), stream ids up to 5
+    static constexpr int32_t kMaxDevices = 128;
+    static constexpr int32_t kMaxStreams = 8;
+
+    TvMessageEnableTable() {
+        for (auto& word : mWords) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static bool isValid(int32_t deviceId, int32_t streamId) {
+        return deviceId >= 0 && deviceId < kMaxDevices && streamId >= 0 && streamId < kMaxStreams;
+    }
+
+    bool set(int32_t deviceId, int32_t streamId, TvMessageEventType type, bool enabled) {
+        if (!isValid(deviceId, streamId)) {
+            return false;
+        }
+        std::atomic<uint32_t>& word = mWords[index(deviceId, streamId)];
+        if (enabled) {
+            word.fetch_or(bit(type), std::memory_order_release);
+        } else {
+            word.fetch_and(~bit(type), std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool isEnabled(int32_t deviceId, int32_t streamId, TvMessageEventType type) const {
+        if (!isValid(deviceId, streamId)) {
+            return false;
+        }
+        return mWords[index(deviceId, streamId)].load(std::memory_order_relaxed) & bit(type);
+    }
+
+  private:
+    static size_t index(int32_t deviceId, int32_t streamId) {
+        return static_cast<size_t>(deviceId) * kMaxStreams + streamId;
+    }
+
+    static uint32_t bit(TvMessageEventType type) {
+        int32_t value = static_cast<int32_t>(type);
+        // OTHER (1000) and anything unknown share the top bit
+        return value >= 0 && value < 31 ? 1u << value : 1u << 31;
+    }
+
+    std::array<std::atomic<uint32_t>, kMaxDevices * kMaxStreams> mWords;
+};
+
+}  // namespace input
+}  // namespace tv
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
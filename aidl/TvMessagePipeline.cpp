@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "android.hardware.tv.input-service"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <algorithm>
+#include <utils/Log.h>
+
+#include "TvMessagePipeline.h"
+#include "TvTrace.h"
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace tv {
+namespace input {
+
+// room for a few seconds of caption data even if the reader stalls
+static constexpr size_t kTvMessageQueueSize = 64 * 1024;
+static constexpr size_t kMaxPendingMessages = 256;
+
+static const char* subTypeOf(TvMessageEventType type) {
+    switch (type) {
+        case TvMessageEventType::CLOSED_CAPTION:
+            return "CTA 608-E";
+        case TvMessageEventType::WATERMARKING:
+            return "ATSC A/335";
+        default:
+            return "";
+    }
+}
+
+TvMessagePipeline::TvMessagePipeline(EnabledChecker enabled, EventSender sender)
+    : mEnabled(enabled), mSender(sender), mExit(false), mGroupId(0), mDropped(0) {
+    mThread = std::thread(&TvMessagePipeline::threadLoop, this);
+}
+
+TvMessagePipeline::~TvMessagePipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mPendingLock);
+        mExit = true;
+    }
+    mPendingCond.notify_all();
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+bool TvMessagePipeline::getQueueDesc(int32_t deviceId, int32_t streamId,
+                                     MQDescriptor<int8_t, SynchronizedReadWrite>* out_queue) {
+    std::lock_guard<std::mutex> lock(mQueueLock);
+
+    std::shared_ptr<TvMessageQueue>& queue = mQueues[StreamKey(deviceId, streamId)];
+    if (queue == nullptr) {
+        queue = std::make_shared<TvMessageQueue>(kTvMessageQueueSize, false);
+        if (!queue->isValid()) {
+            ALOGE("create TvMessage queue for device %d stream %d fail", deviceId, streamId);
+            mQueues.erase(StreamKey(deviceId, streamId));
+            return false;
+        }
+        ALOGD("create TvMessage queue for device %d stream %d", deviceId, streamId);
+    }
+
+    *out_queue = queue->dupeDesc();
+    return true;
+}
+
+void TvMessagePipeline::removeQueue(int32_t deviceId, int32_t streamId) {
+    std::lock_guard<std::mutex> lock(mQueueLock);
+    mQueues.erase(StreamKey(deviceId, streamId));
+}
+
+void TvMessagePipeline::post(int32_t deviceId, int32_t streamId, TvMessageEventType type,
+                             const int32_t* data, size_t size) {
+    if (data == nullptr || size == 0 || size > kTvMessageQueueSize) {
+        return;
+    }
+    if (!mEnabled(deviceId, streamId, type)) {
+        return;
+    }
+
+    std::shared_ptr<TvMessageQueue> queue;
+    {
+        std::lock_guard<std::mutex> lock(mQueueLock);
+        auto it = mQueues.find(StreamKey(deviceId, streamId));
+        if (it != mQueues.end()) {
+            queue = it->second;
+        }
+    }
+    // nobody asked for the queue of this stream yet
+    if (queue == nullptr) {
+        return;
+    }
+
+    {
+        // also keeps the FMQ single writer when tvserver calls back on several threads
+        std::lock_guard<std::mutex> lock(mPendingLock);
+        if (mPending.size() >= kMaxPendingMessages) {
+            if (mDropped++ % 100 == 0) {
+                ALOGW("TvMessage producer is behind, %u messages dropped", mDropped);
+            }
+            return;
+        }
+        if (!writeMessage(queue.get(), data, size)) {
+            return;
+        }
+        mPending.push_back({deviceId, streamId, type, size});
+        TV_TRACE_COUNTER("tv.message.pending", mPending.size());
+    }
+    mPendingCond.notify_one();
+}
+
+void TvMessagePipeline::threadLoop() {
+    std::deque<PendingMessage> batch;
+
+    std::unique_lock<std::mutex> lock(mPendingLock);
+    while (!mExit) {
+        if (mPending.empty()) {
+            mPendingCond.wait(lock);
+            continue;
+        }
+
+        batch.swap(mPending);
+        TV_TRACE_COUNTER("tv.message.pending", 0);
+        lock.unlock();
+        dispatch(batch);
+        batch.clear();
+        lock.lock();
+    }
+}
+
+// Sends one event per run of messages that share (device, stream, type), their
+// payloads are already in the FMQs.
+void TvMessagePipeline::dispatch(std::deque<PendingMessage>& batch) {
+    TvMessageEvent event;
+    int32_t eventDeviceId = -1;
+
+    auto flush = [&]() {
+        if (!event.messages.empty()) {
+            ALOGV("notify %zu TvMessages on device %d stream %d", event.messages.size(),
+                  eventDeviceId, event.streamId);
+            mSender(event);
+        }
+        event.messages.clear();
+    };
+
+    for (const PendingMessage& message : batch) {
+        if (!event.messages.empty() &&
+            (message.deviceId != eventDeviceId || message.streamId != event.streamId ||
+             message.type != event.type)) {
+            flush();
+        }
+
+        eventDeviceId = message.deviceId;
+        event.type = message.type;
+        event.streamId = message.streamId;
+
+        TvMessage tvMessage;
+        tvMessage.subType = subTypeOf(message.type);
+        tvMessage.groupId = mGroupId++;
+        tvMessage.dataLengthBytes = message.size;
+        event.messages.push_back(tvMessage);
+    }
+    flush();
+}
+
+void TvMessagePipeline::dump(int fd) {
+    {
+        std::lock_guard<std::mutex> lock(mPendingLock);
+        dprintf(fd, "TvMessage pending %zu of %zu, %u dropped, next group %" PRId64 "\n",
+                mPending.size(), kMaxPendingMessages, mDropped, mGroupId);
+    }
+
+    std::lock_guard<std::mutex> lock(mQueueLock);
+    for (const auto& entry : mQueues) {
+        dprintf(fd, "  queue %d/%d: %zu of %zu bytes unread\n", entry.first.first,
+                entry.first.second, entry.second->availableToRead(), entry.second->getQuantumCount());
+    }
+}
+
+bool TvMessagePipeline::writeMessage(TvMessageQueue* queue, const int32_t* data, size_t size) {
+    TvMessageQueue::MemTransaction tx;
+
+    if (!queue->beginWrite(size, &tx)) {
+        ALOGW("TvMessage queue full, drop %zu bytes", size);
+        return false;
+    }
+
+    // narrow the HAL buffer straight into the shared ring, which may wrap once
+    const TvMessageQueue::MemRegion regions[] = {tx.getFirstRegion(), tx.getSecondRegion()};
+    size_t written = 0;
+    for (const TvMessageQueue::MemRegion& region : regions) {
+        int8_t* dst = region.getAddress();
+        size_t count = std::min(region.getLength(), size - written);
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = static_cast<int8_t>(data[written + i]);
+        }
+        written += count;
+    }
+    return queue->commitWrite(size);
+}
+
+}  // namespace input
+}  // namespace tv
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
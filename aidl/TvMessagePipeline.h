@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <aidl/android/hardware/tv/input/TvMessageEvent.h>
+#include <aidl/android/hardware/tv/input/TvMessageEventType.h>
+#include <fmq/AidlMessageQueue.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace tv {
+namespace input {
+
+using ::aidl::android::hardware::common::fmq::MQDescriptor;
+using ::aidl::android::hardware::common::fmq::SynchronizedReadWrite;
+using TvMessageQueue = ::android::AidlMessageQueue<int8_t, SynchronizedReadWrite>;
+
+// Moves TvMessage payloads from the HAL into per-(device, stream) FMQs and
+// tells the framework about them with one TvMessageEvent per batch. The
+// payload goes into the FMQ on the posting thread, only the event is deferred.
+class TvMessagePipeline {
+  public:
+    using EnabledChecker = std::function<bool(int32_t deviceId, int32_t streamId,
+                                              TvMessageEventType type)>;
+    using EventSender = std::function<void(const TvMessageEvent& event)>;
+
+    TvMessagePipeline(EnabledChecker enabled, EventSender sender);
+    ~TvMessagePipeline();
+
+    bool getQueueDesc(int32_t deviceId, int32_t streamId,
+                      MQDescriptor<int8_t, SynchronizedReadWrite>* out_queue);
+    void removeQueue(int32_t deviceId, int32_t streamId);
+    // data holds one payload byte per element, see tv_input_message_cb_t
+    void post(int32_t deviceId, int32_t streamId, TvMessageEventType type,
+              const int32_t* data, size_t size);
+    void dump(int fd);
+
+  private:
+    struct PendingMessage {
+        int32_t deviceId;
+        int32_t streamId;
+        TvMessageEventType type;
+        size_t size;
+    };
+    using StreamKey = std::pair<int32_t, int32_t>;
+
+    void threadLoop();
+    void dispatch(std::deque<PendingMessage>& batch);
+    bool writeMessage(TvMessageQueue* queue, const int32_t* data, size_t size);
+
+    EnabledChecker mEnabled;
+    EventSender mSender;
+
+    std::mutex mQueueLock;
+    std::map<StreamKey, std::shared_ptr<TvMessageQueue>> mQueues;
+
+    std::mutex mPendingLock;
+    std::condition_variable mPendingCond;
+    std::deque<PendingMessage> mPending;
+    bool mExit;
+    int64_t mGroupId;
+    uint32_t mDropped;
+    std::thread mThread;
+};
+
+}  // namespace input
+}  // namespace tv
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+#include "TvMethodStats.h"
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace tv {
+namespace input {
+
+static const char* const kMethodNames[] = {
+        "setCallback",
+        "setTvMessageEnabled",
+        "getTvMessageQueueDesc",
+        "getStreamConfigurations",
+        "openStream",
+        "closeStream",
+};
+static_assert(sizeof(kMethodNames) / sizeof(kMethodNames[0]) == static_cast<size_t>(TvMethod::COUNT),
+              "a name for every TvMethod");
+
+TvMethodStats::Scope::Scope(TvMethodStats& stats, TvMethod method)
+    : mStats(stats), mMethod(method), mStart(std::chrono::steady_clock::now()), mFailed(false) {}
+
+TvMethodStats::Scope::~Scope() {
+    auto latency = std::chrono::steady_clock::now() - mStart;
+    mStats.record(mMethod, std::chrono::duration_cast<std::chrono::microseconds>(latency).count(),
+                  mFailed);
+}
+
+void TvMethodStats::record(TvMethod method, int64_t latencyUs, bool failed) {
+    std::lock_guard<std::mutex> lock(mLock);
+    MethodStats& stats = mMethods[static_cast<size_t>(method)];
+
+    stats.latencyUs[stats.calls % kLatencySamples] = latencyUs;
+    stats.calls++;
+    if (failed) {
+        stats.failed++;
+    }
+    stats.maxUs = std::max(stats.maxUs, latencyUs);
+}
+
+void TvMethodStats::reset() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mMethods.fill(MethodStats());
+}
+
+void TvMethodStats::dump(int fd) {
+    decltype(mMethods) methods;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        methods = mMethods;
+    }
+
+    dprintf(fd, "methods (latency us over the last %zu calls):\n", kLatencySamples);
+    for (size_t i = 0; i < methods.size(); i++) {
+        MethodStats& stats = methods[i];
+        if (stats.calls == 0) {
+            dprintf(fd, "  %s: no calls\n", kMethodNames[i]);
+            continue;
+        }
+
+        size_t n = std::min<uint64_t>(stats.calls, kLatencySamples);
+        std::sort(stats.latencyUs.begin(), stats.latencyUs.begin() + n);
+        dprintf(fd, "  %s: %" PRIu64 " calls, %" PRIu64 " failed, p50 %" PRId64 " p90 %" PRId64
+                " p99 %" PRId64 " max %" PRId64 "\n", kMethodNames[i], stats.calls, stats.failed,
+                stats.latencyUs[(n - 1) * 50 / 100], stats.latencyUs[(n - 1) * 90 / 100],
+                stats.latencyUs[(n - 1) * 99 / 100], stats.maxUs);
+    }
+}
+
+}  // namespace input
+}  // namespace tv
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace tv {
+namespace input {
+
+enum class TvMethod {
+    SET_CALLBACK,
+    SET_TV_MESSAGE_ENABLED,
+    GET_TV_MESSAGE_QUEUE_DESC,
+    GET_STREAM_CONFIGURATIONS,
+    OPEN_STREAM,
+    CLOSE_STREAM,
+    COUNT,
+};
+
+// Call counts and latencies of the ITvInput methods for dumpsys.  Percentiles
+// come from the last kLatencySamples calls of each method.
+class TvMethodStats {
+  public:
+    static constexpr size_t kLatencySamples = 128;
+
+    // times one call, the method body marks it failed before returning
+    class Scope {
+      public:
+        Scope(TvMethodStats& stats, TvMethod method);
+        ~Scope();
+
+        void setFailed(bool failed) { mFailed = failed; }
+
+      private:
+        TvMethodStats& mStats;
+        TvMethod mMethod;
+        std::chrono::steady_clock::time_point mStart;
+        bool mFailed;
+    };
+
+    void record(TvMethod method, int64_t latencyUs, bool failed);
+    void reset();
+    void dump(int fd);
+
+  private:
+    struct MethodStats {
+        uint64_t calls = 0;
+        uint64_t failed = 0;
+        int64_t maxUs = 0;
+        std::array<int64_t, kLatencySamples> latencyUs{};
+    };
+
+    std::mutex mLock;
+    std::array<MethodStats, static_cast<size_t>(TvMethod::COUNT)> mMethods;
+};
+
+}  // namespace input
+}  // namespace tv
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
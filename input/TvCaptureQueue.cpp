@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 asynchronous frame capture request queue for tv input hal
+ */
+
+#define LOG_TAG "TvCaptureQueue"
+
+#include <errno.h>
+#include <string.h>
+#include <vector>
+#include <utils/Log.h>
+
+#include "TvCaptureQueue.h"
+#include "TvTrace.h"
+
+TvCaptureQueue::TvCaptureQueue(CaptureHandler capture, CompleteHandler complete, void *data)
+    : mCapture(capture),
+      mComplete(complete),
+      mData(data),
+      mThreadStarted(false),
+      mExit(false),
+      mInFlight(false),
+      mTotalLatencyUs(0)
+{
+    memset(&mStats, 0, sizeof(mStats));
+    memset(&mInFlightRequest, 0, sizeof(mInFlightRequest));
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, NULL);
+
+    if (pthread_create(&mThread, NULL, workerThread, this) == 0) {
+        mThreadStarted = true;
+    } else {
+        ALOGE("create capture worker fail: %s", strerror(errno));
+    }
+}
+
+TvCaptureQueue::~TvCaptureQueue()
+{
+    std::deque<tv_capture_request_t> pending;
+
+    pthread_mutex_lock(&mMutex);
+    mExit = true;
+    pending.swap(mRequests);
+    mStreamDepth.clear();
+    mStats.cancelled += pending.size();
+    mStats.depth = 0;
+    TV_TRACE_COUNTER("tv.capture.depth", mStats.depth);
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    if (mThreadStarted)
+        pthread_join(mThread, NULL);
+
+    for (size_t i = 0; i < pending.size(); i++)
+        mComplete(mData, pending[i], -ECANCELED);
+
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+int TvCaptureQueue::enqueue(int device_id, int stream_id, buffer_handle_t buffer, uint32_t seq)
+{
+    if (buffer == NULL)
+        return -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+
+    if (!mThreadStarted || mExit) {
+        pthread_mutex_unlock(&mMutex);
+        return -EWOULDBLOCK;
+    }
+
+    StreamKey key(device_id, stream_id);
+    for (size_t i = 0; i < mRequests.size(); i++) {
+        if (mRequests[i].device_id == device_id && mRequests[i].stream_id == stream_id
+            && mRequests[i].seq == seq) {
+            ALOGW("capture seq %u already queued for device %d stream %d", seq, device_id, stream_id);
+            pthread_mutex_unlock(&mMutex);
+            return -EINVAL;
+        }
+    }
+
+    int &depth = mStreamDepth[key];
+    if (depth >= CAPTURE_QUEUE_MAX_DEPTH) {
+        ALOGW("capture queue full for device %d stream %d, drop seq %u", device_id, stream_id, seq);
+        pthread_mutex_unlock(&mMutex);
+        return -EWOULDBLOCK;
+    }
+
+    tv_capture_request_t request;
+    request.device_id = device_id;
+    request.stream_id = stream_id;
+    request.buffer = buffer;
+    request.seq = seq;
+    request.enqueueTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    mRequests.push_back(request);
+    depth++;
+
+    mStats.depth = mRequests.size();
+    TV_TRACE_COUNTER("tv.capture.depth", mStats.depth);
+    if (mStats.depth > mStats.maxDepth)
+        mStats.maxDepth = mStats.depth;
+
+    ALOGV("queue capture device %d stream %d seq %u, depth %d", device_id, stream_id, seq, mStats.depth);
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    return 0;
+}
+
+int TvCaptureQueue::cancel(int device_id, int stream_id, uint32_t seq)
+{
+    tv_capture_request_t request;
+    bool found = false;
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+
+    for (std::deque<tv_capture_request_t>::iterator it = mRequests.begin(); it != mRequests.end(); ++it) {
+        if (it->device_id == device_id && it->stream_id == stream_id && it->seq == seq) {
+            request = *it;
+            mRequests.erase(it);
+            StreamKey key(device_id, stream_id);
+            if (--mStreamDepth[key] <= 0)
+                mStreamDepth.erase(key);
+            mStats.depth = mRequests.size();
+            TV_TRACE_COUNTER("tv.capture.depth", mStats.depth);
+            mStats.cancelled++;
+            found = true;
+            ret = 0;
+            break;
+        }
+    }
+
+    if (!found && mInFlight && mInFlightRequest.device_id == device_id
+        && mInFlightRequest.stream_id == stream_id && mInFlightRequest.seq == seq) {
+        // already handed to the hardware, its result will still be reported
+        ret = -EBUSY;
+    }
+
+    pthread_mutex_unlock(&mMutex);
+
+    ALOGD("cancel capture device %d stream %d seq %u, ret %d", device_id, stream_id, seq, ret);
+    if (found)
+        mComplete(mData, request, -ECANCELED);
+
+    return ret;
+}
+
+void TvCaptureQueue::flush(int device_id, int stream_id)
+{
+    std::vector<tv_capture_request_t> flushed;
+
+    pthread_mutex_lock(&mMutex);
+    for (std::deque<tv_capture_request_t>::iterator it = mRequests.begin(); it != mRequests.end();) {
+        if (it->device_id == device_id && it->stream_id == stream_id) {
+            flushed.push_back(*it);
+            it = mRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mStreamDepth.erase(StreamKey(device_id, stream_id));
+    mStats.depth = mRequests.size();
+    TV_TRACE_COUNTER("tv.capture.depth", mStats.depth);
+    mStats.cancelled += flushed.size();
+    pthread_mutex_unlock(&mMutex);
+
+    for (size_t i = 0; i < flushed.size(); i++)
+        mComplete(mData, flushed[i], -ECANCELED);
+}
+
+void TvCaptureQueue::getStats(tv_capture_stats_t *stats)
+{
+    pthread_mutex_lock(&mMutex);
+    *stats = mStats;
+    pthread_mutex_unlock(&mMutex);
+}
+
+void TvCaptureQueue::resetStats()
+{
+    pthread_mutex_lock(&mMutex);
+    int depth = mStats.depth;
+    memset(&mStats, 0, sizeof(mStats));
+    mStats.depth = depth;
+    mStats.maxDepth = depth;
+    mTotalLatencyUs = 0;
+    pthread_mutex_unlock(&mMutex);
+}
+
+void *TvCaptureQueue::workerThread(void *arg)
+{
+    TvCaptureQueue *queue = (TvCaptureQueue *)arg;
+    queue->threadLoop();
+    return NULL;
+}
+
+void TvCaptureQueue::threadLoop()
+{
+    pthread_mutex_lock(&mMutex);
+    while (!mExit) {
+        if (mRequests.empty()) {
+            pthread_cond_wait(&mCond, &mMutex);
+            continue;
+        }
+
+        tv_capture_request_t request = mRequests.front();
+        mRequests.pop_front();
+        StreamKey key(request.device_id, request.stream_id);
+        if (--mStreamDepth[key] <= 0)
+            mStreamDepth.erase(key);
+        mStats.depth = mRequests.size();
+        TV_TRACE_COUNTER("tv.capture.depth", mStats.depth);
+        mInFlight = true;
+        mInFlightRequest = request;
+        pthread_mutex_unlock(&mMutex);
+
+        int status = mCapture(mData, request);
+
+        pthread_mutex_lock(&mMutex);
+        mInFlight = false;
+        recordLatency(request, status);
+        pthread_mutex_unlock(&mMutex);
+
+        mComplete(mData, request, status);
+
+        pthread_mutex_lock(&mMutex);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
+void TvCaptureQueue::recordLatency(const tv_capture_request_t &request, int status)
+{
+    int64_t latencyUs = ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - request.enqueueTime);
+
+    if (status == 0)
+        mStats.completed++;
+    else
+        mStats.failed++;
+
+    mTotalLatencyUs += latencyUs;
+    mStats.lastLatencyUs = latencyUs;
+    mStats.avgLatencyUs = mTotalLatencyUs / (mStats.completed + mStats.failed);
+    if (latencyUs > mStats.maxLatencyUs)
+        mStats.maxLatencyUs = latencyUs;
+
+    ALOGD("capture device %d stream %d seq %u done, status %d, latency %lldus, depth %d",
+            request.device_id, request.stream_id, request.seq, status,
+            (long long)latencyUs, mStats.depth);
+}
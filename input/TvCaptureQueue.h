@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 asynchronous frame capture request queue for tv input hal
+ */
+
+#ifndef _ANDROID_TV_CAPTURE_QUEUE_H_
+#define _ANDROID_TV_CAPTURE_QUEUE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <utility>
+
+#include <cutils/native_handle.h>
+#include <utils/Timers.h>
+
+#define CAPTURE_QUEUE_MAX_DEPTH 4
+
+typedef struct tv_capture_request {
+    int device_id;
+    int stream_id;
+    buffer_handle_t buffer;
+    uint32_t seq;
+    nsecs_t enqueueTime;
+} tv_capture_request_t;
+
+typedef struct tv_capture_stats {
+    int depth;
+    int maxDepth;
+    uint32_t completed;
+    uint32_t failed;
+    uint32_t cancelled;
+    int64_t lastLatencyUs;
+    int64_t avgLatencyUs;
+    int64_t maxLatencyUs;
+} tv_capture_stats_t;
+
+/*
+ * Requests are kept per (device_id, stream_id) with a bounded depth and
+ * serviced in arrival order by one worker thread, so request_capture never
+ * blocks a binder thread on the hardware.  A request can be withdrawn with
+ * cancel() until the worker has picked it up.
+ */
+class TvCaptureQueue {
+public:
+    // runs on the worker thread, returns 0 when the buffer has been filled
+    typedef int (*CaptureHandler)(void *data, const tv_capture_request_t &request);
+    // reports the final state of a request: 0, a capture error, or -ECANCELED
+    typedef void (*CompleteHandler)(void *data, const tv_capture_request_t &request, int status);
+
+    TvCaptureQueue(CaptureHandler capture, CompleteHandler complete, void *data);
+    ~TvCaptureQueue();
+
+    int enqueue(int device_id, int stream_id, buffer_handle_t buffer, uint32_t seq);
+    int cancel(int device_id, int stream_id, uint32_t seq);
+    void flush(int device_id, int stream_id);
+    void getStats(tv_capture_stats_t *stats);
+    // clears the counters and maxima, depth stays
+    void resetStats();
+
+private:
+    typedef std::pair<int, int> StreamKey;
+
+    static void *workerThread(void *arg);
+    void threadLoop();
+    void recordLatency(const tv_capture_request_t &request, int status);
+
+    CaptureHandler mCapture;
+    CompleteHandler mComplete;
+    void *mData;
+
+    pthread_mutex_t mMutex;
+    pthread_cond_t mCond;
+    pthread_t mThread;
+    bool mThreadStarted;
+    bool mExit;
+
+    std::deque<tv_capture_request_t> mRequests;
+    std::map<StreamKey, int> mStreamDepth;
+    bool mInFlight;
+    tv_capture_request_t mInFlightRequest;
+
+    tv_capture_stats_t mStats;
+    int64_t mTotalLatencyUs;
+};
+
+#endif/*_ANDROID_TV_CAPTURE_QUEUE_H_*/
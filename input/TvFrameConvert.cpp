@@ -0,0 +1,476 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 pixel format conversion and scaling for captured frames
+ */
+
+#define LOG_TAG "TvFrameConvert"
+
+#include <errno.h>
+#include <string.h>
+#include <vector>
+#include <utils/Log.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TV_FRAME_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TV_FRAME_USE_SSE2 1
+#endif
+
+#include "TvFrameConvert.h"
+
+/*
+ * Row kernels.  Every kernel handles the bulk of a row with NEON or SSE2
+ * and finishes the tail with the scalar code, which is also the reference
+ * the vector paths are bit exact with:
+ *   R = (298 * (Y - 16) + 409 * (V - 128) + 128) >> 8
+ *   G = (298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8
+ *   B = (298 * (Y - 16) + 516 * (U - 128) + 128) >> 8
+ */
+
+static inline uint8_t clampU8(int v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline void yuvToRgb(int y, int u, int v, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    int yy = 298 * (y - 16) + 128;
+    u -= 128;
+    v -= 128;
+    *r = clampU8((yy + 409 * v) >> 8);
+    *g = clampU8((yy - 100 * u - 208 * v) >> 8);
+    *b = clampU8((yy + 516 * u) >> 8);
+}
+
+#if defined(TV_FRAME_USE_NEON)
+static inline void neonYuvToRgb(uint8x8_t y, uint8x8_t u, uint8x8_t v,
+        uint8x8_t *r, uint8x8_t *g, uint8x8_t *b)
+{
+    int16x8_t yy = vreinterpretq_s16_u16(vsubl_u8(y, vdup_n_u8(16)));
+    int16x8_t uu = vreinterpretq_s16_u16(vsubl_u8(u, vdup_n_u8(128)));
+    int16x8_t vv = vreinterpretq_s16_u16(vsubl_u8(v, vdup_n_u8(128)));
+
+    int32x4_t yl = vmull_n_s16(vget_low_s16(yy), 298);
+    int32x4_t yh = vmull_n_s16(vget_high_s16(yy), 298);
+
+    int32x4_t rl = vmlal_n_s16(yl, vget_low_s16(vv), 409);
+    int32x4_t rh = vmlal_n_s16(yh, vget_high_s16(vv), 409);
+    int32x4_t gl = vmlsl_n_s16(vmlsl_n_s16(yl, vget_low_s16(uu), 100), vget_low_s16(vv), 208);
+    int32x4_t gh = vmlsl_n_s16(vmlsl_n_s16(yh, vget_high_s16(uu), 100), vget_high_s16(vv), 208);
+    int32x4_t bl = vmlal_n_s16(yl, vget_low_s16(uu), 516);
+    int32x4_t bh = vmlal_n_s16(yh, vget_high_s16(uu), 516);
+
+    *r = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(rl, 8), vqrshrn_n_s32(rh, 8)));
+    *g = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(gl, 8), vqrshrn_n_s32(gh, 8)));
+    *b = vqmovun_s16(vcombine_s16(vqrshrn_n_s32(bl, 8), vqrshrn_n_s32(bh, 8)));
+}
+
+static inline uint16x8_t neonPackRgb565(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t px = vshll_n_u8(r, 8);
+    px = vsriq_n_u16(px, vshll_n_u8(g, 8), 5);
+    return vsriq_n_u16(px, vshll_n_u8(b, 8), 11);
+}
+#elif defined(TV_FRAME_USE_SSE2)
+// 16x16 -> 32 bit signed products of eight lanes
+static inline void sseMul(__m128i a, int16_t k, __m128i *lo, __m128i *hi)
+{
+    __m128i c = _mm_set1_epi16(k);
+    __m128i pl = _mm_mullo_epi16(a, c);
+    __m128i ph = _mm_mulhi_epi16(a, c);
+    *lo = _mm_unpacklo_epi16(pl, ph);
+    *hi = _mm_unpackhi_epi16(pl, ph);
+}
+
+static inline __m128i sseNarrow(__m128i lo, __m128i hi)
+{
+    __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+    return _mm_unpacklo_epi8(_mm_packus_epi16(v, v), _mm_setzero_si128());
+}
+
+// inputs are eight offset samples (Y - 16, U - 128, V - 128), outputs 0..255 per lane
+static inline void sseYuvToRgb(__m128i y, __m128i u, __m128i v, __m128i *r, __m128i *g, __m128i *b)
+{
+    const __m128i round = _mm_set1_epi32(128);
+    __m128i yl, yh, tl, th, gl, gh;
+
+    sseMul(y, 298, &yl, &yh);
+    yl = _mm_add_epi32(yl, round);
+    yh = _mm_add_epi32(yh, round);
+
+    sseMul(v, 409, &tl, &th);
+    *r = sseNarrow(_mm_add_epi32(yl, tl), _mm_add_epi32(yh, th));
+
+    sseMul(u, -100, &tl, &th);
+    gl = _mm_add_epi32(yl, tl);
+    gh = _mm_add_epi32(yh, th);
+    sseMul(v, -208, &tl, &th);
+    *g = sseNarrow(_mm_add_epi32(gl, tl), _mm_add_epi32(gh, th));
+
+    sseMul(u, 516, &tl, &th);
+    *b = sseNarrow(_mm_add_epi32(yl, tl), _mm_add_epi32(yh, th));
+}
+
+// loads 16 luma and 8 chroma pairs and returns them as two halves of offset int16 lanes
+static inline void sseLoadNv(const uint8_t *y, const uint8_t *uv, bool vFirst,
+        __m128i yy[2], __m128i uu[2], __m128i vv[2])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    const __m128i off16 = _mm_set1_epi16(16);
+    const __m128i off128 = _mm_set1_epi16(128);
+
+    __m128i y16 = _mm_loadu_si128((const __m128i *)y);
+    __m128i c = _mm_loadu_si128((const __m128i *)uv);
+    __m128i c0 = _mm_sub_epi16(_mm_and_si128(c, mask), off128);
+    __m128i c1 = _mm_sub_epi16(_mm_srli_epi16(c, 8), off128);
+    __m128i u = vFirst ? c1 : c0;
+    __m128i v = vFirst ? c0 : c1;
+
+    yy[0] = _mm_sub_epi16(_mm_unpacklo_epi8(y16, zero), off16);
+    yy[1] = _mm_sub_epi16(_mm_unpackhi_epi8(y16, zero), off16);
+    uu[0] = _mm_unpacklo_epi16(u, u);
+    uu[1] = _mm_unpackhi_epi16(u, u);
+    vv[0] = _mm_unpacklo_epi16(v, v);
+    vv[1] = _mm_unpackhi_epi16(v, v);
+}
+#endif
+
+static void nvRowToRgba(const uint8_t *y, const uint8_t *uv, bool vFirst, uint8_t *dst, int width)
+{
+    int x = 0;
+#if defined(TV_FRAME_USE_NEON)
+    uint8x8x4_t px;
+    px.val[3] = vdup_n_u8(255);
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y16 = vld1q_u8(y + x);
+        uint8x8x2_t c = vld2_u8(uv + x);
+        uint8x8_t u8 = vFirst ? c.val[1] : c.val[0];
+        uint8x8_t v8 = vFirst ? c.val[0] : c.val[1];
+        uint8x8x2_t u16 = vzip_u8(u8, u8);
+        uint8x8x2_t v16 = vzip_u8(v8, v8);
+
+        neonYuvToRgb(vget_low_u8(y16), u16.val[0], v16.val[0], &px.val[0], &px.val[1], &px.val[2]);
+        vst4_u8(dst + x * 4, px);
+        neonYuvToRgb(vget_high_u8(y16), u16.val[1], v16.val[1], &px.val[0], &px.val[1], &px.val[2]);
+        vst4_u8(dst + x * 4 + 32, px);
+    }
+#elif defined(TV_FRAME_USE_SSE2)
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+    for (; x + 16 <= width; x += 16) {
+        __m128i yy[2], uu[2], vv[2];
+        sseLoadNv(y + x, uv + x, vFirst, yy, uu, vv);
+        for (int half = 0; half < 2; half++) {
+            __m128i r, g, b;
+            sseYuvToRgb(yy[half], uu[half], vv[half], &r, &g, &b);
+            __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+            __m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), alpha);
+            uint8_t *out = dst + (x + half * 8) * 4;
+            _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi16(rg, ba));
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t *c = uv + (x & ~1);
+        uint8_t *out = dst + x * 4;
+        yuvToRgb(y[x], vFirst ? c[1] : c[0], vFirst ? c[0] : c[1], &out[0], &out[1], &out[2]);
+        out[3] = 255;
+    }
+}
+
+static void nvRowToRgb565(const uint8_t *y, const uint8_t *uv, bool vFirst, uint16_t *dst, int width)
+{
+    int x = 0;
+#if defined(TV_FRAME_USE_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t y16 = vld1q_u8(y + x);
+        uint8x8x2_t c = vld2_u8(uv + x);
+        uint8x8_t u8 = vFirst ? c.val[1] : c.val[0];
+        uint8x8_t v8 = vFirst ? c.val[0] : c.val[1];
+        uint8x8x2_t u16 = vzip_u8(u8, u8);
+        uint8x8x2_t v16 = vzip_u8(v8, v8);
+        uint8x8_t r, g, b;
+
+        neonYuvToRgb(vget_low_u8(y16), u16.val[0], v16.val[0], &r, &g, &b);
+        vst1q_u16(dst + x, neonPackRgb565(r, g, b));
+        neonYuvToRgb(vget_high_u8(y16), u16.val[1], v16.val[1], &r, &g, &b);
+        vst1q_u16(dst + x + 8, neonPackRgb565(r, g, b));
+    }
+#elif defined(TV_FRAME_USE_SSE2)
+    const __m128i maskR = _mm_set1_epi16(0xf8);
+    const __m128i maskG = _mm_set1_epi16(0xfc);
+    for (; x + 16 <= width; x += 16) {
+        __m128i yy[2], uu[2], vv[2];
+        sseLoadNv(y + x, uv + x, vFirst, yy, uu, vv);
+        for (int half = 0; half < 2; half++) {
+            __m128i r, g, b;
+            sseYuvToRgb(yy[half], uu[half], vv[half], &r, &g, &b);
+            __m128i px = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, maskR), 8),
+                    _mm_or_si128(_mm_slli_epi16(_mm_and_si128(g, maskG), 3), _mm_srli_epi16(b, 3)));
+            _mm_storeu_si128((__m128i *)(dst + x + half * 8), px);
+        }
+    }
+#endif
+    for (; x < width; x++) {
+        const uint8_t *c = uv + (x & ~1);
+        uint8_t r, g, b;
+        yuvToRgb(y[x], vFirst ? c[1] : c[0], vFirst ? c[0] : c[1], &r, &g, &b);
+        dst[x] = (uint16_t)(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+    }
+}
+
+// YUYV -> one luma row and one U/V interleaved chroma row
+static void yuyvRowUnpack(const uint8_t *src, uint8_t *y, uint8_t *uv, int width)
+{
+    int x = 0;
+#if defined(TV_FRAME_USE_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x8x4_t s = vld4_u8(src + x * 2);
+        uint8x8x2_t luma = { { s.val[0], s.val[2] } };
+        uint8x8x2_t chroma = { { s.val[1], s.val[3] } };
+        vst2_u8(y + x, luma);
+        vst2_u8(uv + x, chroma);
+    }
+#elif defined(TV_FRAME_USE_SSE2)
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    for (; x + 16 <= width; x += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + x * 2));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + x * 2 + 16));
+        _mm_storeu_si128((__m128i *)(y + x),
+                _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask)));
+        _mm_storeu_si128((__m128i *)(uv + x),
+                _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+#endif
+    // an odd last pixel has no V, the caller keeps uv[width] neutral
+    for (; x < width; x += 2) {
+        const uint8_t *s = src + x * 2;
+        y[x] = s[0];
+        uv[x] = s[1];
+        if (x + 1 < width) {
+            y[x + 1] = s[2];
+            uv[x + 1] = s[3];
+        }
+    }
+}
+
+// P010 keeps the sample in the upper 10 bits, the upper byte is the 8 bit value
+static void p010RowTo8(const uint16_t *src, uint8_t *dst, int count)
+{
+    int i = 0;
+#if defined(TV_FRAME_USE_NEON)
+    for (; i + 16 <= count; i += 16) {
+        uint16x8_t a = vld1q_u16(src + i);
+        uint16x8_t b = vld1q_u16(src + i + 8);
+        vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(a, 8), vshrn_n_u16(b, 8)));
+    }
+#elif defined(TV_FRAME_USE_SSE2)
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 8));
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = (uint8_t)(src[i] >> 8);
+}
+
+// NV12 <-> NV21 chroma order swap
+static void uvRowSwap(const uint8_t *src, uint8_t *dst, int bytes)
+{
+    int i = 0;
+#if defined(TV_FRAME_USE_NEON)
+    for (; i + 16 <= bytes; i += 16)
+        vst1q_u8(dst + i, vrev16q_u8(vld1q_u8(src + i)));
+#elif defined(TV_FRAME_USE_SSE2)
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_slli_epi16(c, 8), _mm_srli_epi16(c, 8)));
+    }
+#endif
+    for (; i + 1 < bytes; i += 2) {
+        uint8_t c = src[i];
+        dst[i] = src[i + 1];
+        dst[i + 1] = c;
+    }
+}
+
+// nearest neighbour, xOffset[] maps every destination column to a source column
+static void scaleRowY(const uint8_t *src, uint8_t *dst, const int *xOffset, int width)
+{
+    for (int x = 0; x < width; x++)
+        dst[x] = src[xOffset[x]];
+}
+
+static void scaleRowUV(const uint8_t *src, uint8_t *dst, const int *xOffset, int width)
+{
+    for (int x = 0; x < width; x += 2) {
+        int sx = xOffset[x] & ~1;
+        dst[x] = src[sx];
+        dst[x + 1] = src[sx + 1];
+    }
+}
+
+void tvFrameCopyPlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride,
+        int widthBytes, int height)
+{
+    if (srcStride == dstStride && srcStride == widthBytes) {
+        memcpy(dst, src, (size_t)widthBytes * height);
+        return;
+    }
+
+    for (int y = 0; y < height; y++) {
+        memcpy(dst, src, widthBytes);
+        src += srcStride;
+        dst += dstStride;
+    }
+}
+
+static inline int chromaRowBytes(int width)
+{
+    return (width + 1) & ~1;
+}
+
+static bool isYuvSource(tv_frame_format_t format)
+{
+    return format == TV_FRAME_FORMAT_NV21 || format == TV_FRAME_FORMAT_NV12
+        || format == TV_FRAME_FORMAT_YUYV || format == TV_FRAME_FORMAT_P010;
+}
+
+static bool isSemiPlanar(tv_frame_format_t format)
+{
+    return format == TV_FRAME_FORMAT_NV21 || format == TV_FRAME_FORMAT_NV12
+        || format == TV_FRAME_FORMAT_P010;
+}
+
+static bool checkFrame(const tv_frame_t *frame)
+{
+    if (frame->width <= 0 || frame->height <= 0 || frame->plane[0] == NULL)
+        return false;
+    if (isSemiPlanar(frame->format) && frame->plane[1] == NULL)
+        return false;
+    return true;
+}
+
+int tvFrameConvert(const tv_frame_t *src, tv_frame_t *dst)
+{
+    if (src == NULL || dst == NULL || !checkFrame(src) || !checkFrame(dst))
+        return -EINVAL;
+
+    if (!isYuvSource(src->format) || dst->format == TV_FRAME_FORMAT_YUYV
+        || dst->format == TV_FRAME_FORMAT_P010) {
+        ALOGE("unsupported conversion %d -> %d", src->format, dst->format);
+        return -EINVAL;
+    }
+
+    const int sw = src->width;
+    const int sh = src->height;
+    const int dw = dst->width;
+    const int dh = dst->height;
+
+    // same layout and size is a plain stride aware copy
+    if (sw == dw && sh == dh && src->format == dst->format) {
+        tvFrameCopyPlane(src->plane[0], src->stride[0], dst->plane[0], dst->stride[0], dw, dh);
+        tvFrameCopyPlane(src->plane[1], src->stride[1], dst->plane[1], dst->stride[1],
+                    chromaRowBytes(dw), (dh + 1) / 2);
+        return 0;
+    }
+
+    const bool scale = (sw != dw);
+    std::vector<int> xOffset;
+    if (scale) {
+        xOffset.resize(dw);
+        for (int x = 0; x < dw; x++)
+            xOffset[x] = (int)(((int64_t)(2 * x + 1) * sw) / (2 * dw));
+    }
+
+    const int rowBytes = (sw > dw ? sw : dw) + 32;
+    std::vector<uint8_t> yRow, uvRow, yScaled, uvScaled;
+    if (src->format == TV_FRAME_FORMAT_YUYV || src->format == TV_FRAME_FORMAT_P010) {
+        yRow.resize(rowBytes);
+        uvRow.assign(rowBytes, 128);
+    }
+    if (scale) {
+        yScaled.resize(rowBytes);
+        uvScaled.resize(rowBytes);
+    }
+
+    for (int y = 0; y < dh; y++) {
+        int sy = (sh == dh) ? y : (int)(((int64_t)(2 * y + 1) * sh) / (2 * dh));
+        const uint8_t *yLine = NULL;
+        const uint8_t *uvLine = NULL;
+        bool vFirst = false;
+
+        switch (src->format) {
+            case TV_FRAME_FORMAT_NV21:
+            case TV_FRAME_FORMAT_NV12:
+                yLine = src->plane[0] + (size_t)sy * src->stride[0];
+                uvLine = src->plane[1] + (size_t)(sy / 2) * src->stride[1];
+                vFirst = (src->format == TV_FRAME_FORMAT_NV21);
+                break;
+            case TV_FRAME_FORMAT_YUYV:
+                yuyvRowUnpack(src->plane[0] + (size_t)sy * src->stride[0], yRow.data(), uvRow.data(), sw);
+                yLine = yRow.data();
+                uvLine = uvRow.data();
+                break;
+            case TV_FRAME_FORMAT_P010:
+                p010RowTo8((const uint16_t *)(src->plane[0] + (size_t)sy * src->stride[0]), yRow.data(), sw);
+                p010RowTo8((const uint16_t *)(src->plane[1] + (size_t)(sy / 2) * src->stride[1]),
+                        uvRow.data(), chromaRowBytes(sw));
+                yLine = yRow.data();
+                uvLine = uvRow.data();
+                break;
+            default:
+                return -EINVAL;
+        }
+
+        if (scale) {
+            scaleRowY(yLine, yScaled.data(), xOffset.data(), dw);
+            scaleRowUV(uvLine, uvScaled.data(), xOffset.data(), dw);
+            yLine = yScaled.data();
+            uvLine = uvScaled.data();
+        }
+
+        uint8_t *out = dst->plane[0] + (size_t)y * dst->stride[0];
+        switch (dst->format) {
+            case TV_FRAME_FORMAT_RGBA8888:
+                nvRowToRgba(yLine, uvLine, vFirst, out, dw);
+                break;
+            case TV_FRAME_FORMAT_RGB565:
+                nvRowToRgb565(yLine, uvLine, vFirst, (uint16_t *)out, dw);
+                break;
+            case TV_FRAME_FORMAT_NV21:
+            case TV_FRAME_FORMAT_NV12:
+                memcpy(out, yLine, dw);
+                if ((y & 1) == 0) {
+                    uint8_t *uvOut = dst->plane[1] + (size_t)(y / 2) * dst->stride[1];
+                    if ((dst->format == TV_FRAME_FORMAT_NV21) == vFirst)
+                        memcpy(uvOut, uvLine, chromaRowBytes(dw));
+                    else
+                        uvRowSwap(uvLine, uvOut, chromaRowBytes(dw));
+                }
+                break;
+            default:
+                return -EINVAL;
+        }
+    }
+
+    return 0;
+}
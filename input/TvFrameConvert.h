@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 pixel format conversion and scaling for captured frames
+ */
+
+#ifndef _ANDROID_TV_FRAME_CONVERT_H_
+#define _ANDROID_TV_FRAME_CONVERT_H_
+
+#include <stdint.h>
+
+typedef enum tv_frame_format_e {
+    TV_FRAME_FORMAT_NV21 = 0,
+    TV_FRAME_FORMAT_NV12,
+    TV_FRAME_FORMAT_YUYV,
+    TV_FRAME_FORMAT_P010,
+    TV_FRAME_FORMAT_RGBA8888,
+    TV_FRAME_FORMAT_RGB565,
+} tv_frame_format_t;
+
+/*
+ * plane[1] is only used by the semi-planar formats (interleaved chroma).
+ * Strides are in bytes.
+ */
+typedef struct tv_frame_s {
+    tv_frame_format_t format;
+    int width;
+    int height;
+    uint8_t *plane[2];
+    int stride[2];
+} tv_frame_t;
+
+/*
+ * Converts src into dst, scaling to dst->width x dst->height when the sizes
+ * differ.  Sources: NV21, NV12, YUYV, P010.  Destinations: RGBA8888, RGB565,
+ * NV21, NV12 (P010 is reduced to 8 bit).  YUV to RGB uses BT.601 limited
+ * range.  Returns 0, or -EINVAL for an unsupported pair or bad geometry.
+ */
+int tvFrameConvert(const tv_frame_t *src, tv_frame_t *dst);
+
+void tvFrameCopyPlane(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride,
+        int widthBytes, int height);
+
+#endif/*_ANDROID_TV_FRAME_CONVERT_H_*/
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 video layer frame source for tv input capture
+ */
+
+#define LOG_TAG "TvFrameGrabber"
+
+#include <errno.h>
+#include <utils/Log.h>
+#include <binder/IServiceManager.h>
+
+#include "TvClient.h"
+#include "TvFrameGrabber.h"
+
+using namespace android;
+
+TvFrameGrabber::TvFrameGrabber(int width, int height)
+    : mWidth(width),
+      mHeight(height)
+{
+    pthread_mutex_init(&mMutex, NULL);
+}
+
+TvFrameGrabber::~TvFrameGrabber()
+{
+    disconnect();
+    pthread_mutex_destroy(&mMutex);
+}
+
+bool TvFrameGrabber::connect()
+{
+    if (mTvClient != NULL)
+        return true;
+
+    // TvClient::connect() waits forever for tvservice, don't block the worker on it
+    if (defaultServiceManager()->checkService(String16("tvservice")) == NULL) {
+        ALOGE("tvservice is not published, no capture source");
+        return false;
+    }
+
+    mTvClient = TvClient::connect();
+    if (mTvClient == NULL) {
+        ALOGE("connect tvservice fail");
+        return false;
+    }
+
+    size_t size = (size_t)mWidth * mHeight * 3 / 2;
+    mSession = mTvClient->createVideoFrameSession(size, 2);
+    if (mSession == NULL) {
+        ALOGE("create capture session size %zu fail", size);
+        mTvClient.clear();
+        return false;
+    }
+    return true;
+}
+
+void TvFrameGrabber::disconnect()
+{
+    mSession.clear();
+    mTvClient.clear();
+}
+
+int TvFrameGrabber::grabInto(tv_frame_t *dst)
+{
+    tv_video_frame_t captured;
+    tv_frame_t src;
+    int ret;
+
+    pthread_mutex_lock(&mMutex);
+    if (!connect()) {
+        pthread_mutex_unlock(&mMutex);
+        return -ENODEV;
+    }
+
+    // source mode 0 is the video layer, capture it without osd
+    status_t status = mSession->capture(0, 1);
+    if (status != NO_ERROR) {
+        ALOGE("createVideoFrame fail %d", status);
+        if (status == DEAD_OBJECT)
+            disconnect();
+        pthread_mutex_unlock(&mMutex);
+        return -EWOULDBLOCK;
+    }
+
+    ret = -EWOULDBLOCK;
+    if (mSession->acquire(&captured) == NO_ERROR) {
+        uint8_t *base = (uint8_t *)captured.base;
+        src.format = TV_FRAME_FORMAT_NV21;
+        src.width = mWidth;
+        src.height = mHeight;
+        src.plane[0] = base;
+        src.plane[1] = base + (size_t)mWidth * mHeight;
+        src.stride[0] = mWidth;
+        src.stride[1] = mWidth;
+        ret = tvFrameConvert(&src, dst);
+        mSession->release(captured);
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 video layer frame source for tv input capture
+ */
+
+#ifndef _ANDROID_TV_FRAME_GRABBER_H_
+#define _ANDROID_TV_FRAME_GRABBER_H_
+
+#include <pthread.h>
+#include <utils/StrongPointer.h>
+
+#include "TvFrameConvert.h"
+
+class TvClient;
+class TvVideoFrameSession;
+
+/*
+ * Grabs the current video layer from tvservice as an NV21 frame of a fixed
+ * size and converts it into the caller's frame.  The capture buffers come
+ * from a TvVideoFrameSession allocated once, grabs are serialized.
+ */
+class TvFrameGrabber {
+public:
+    TvFrameGrabber(int width, int height);
+    ~TvFrameGrabber();
+
+    int grabInto(tv_frame_t *dst);
+
+private:
+    bool connect();
+    void disconnect();
+
+    pthread_mutex_t mMutex;
+
+    int mWidth;
+    int mHeight;
+    android::sp<TvClient> mTvClient;
+    android::sp<TvVideoFrameSession> mSession;
+};
+
+#endif/*_ANDROID_TV_FRAME_GRABBER_H_*/
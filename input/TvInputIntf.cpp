@@ -22,28 +22,36 @@
 #define LOG_TAG "TvInputIntf"
 
 #include <utils/Log.h>
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
 #include "TvInputIntf.h"
+#include "TvSourceTraits.h"
 #include "tvcmd.h"
+#include "TvTrace.h"
 #include <math.h>
 #include <cutils/properties.h>
 
 #ifdef SUPPORT_DTVKIT
-#include "DTVKitHidlClient.h"
 #include <json/json.h>
 #endif
 
 #define TV_INPUT_VERSION "V2.01"
 
 using namespace android;
-#ifdef SUPPORT_DTVKIT
-sp<DTVKitHidlClient> mDkSession = nullptr;
-#endif
 
 TvInputIntf::TvInputIntf() : mpObserver(nullptr) {
     mTvSession = TvServerHidlClient::connect(CONNECT_TYPE_HAL);
     mTvSession->setListener(this);
+    // samples the decoder while a demux fed source plays, 0 turns it off
+    mVdecSamplePeriod = ms2ns(property_get_int32("vendor.tv.vdec_sampler.period_ms", 1000));
+    mVdecSampler = new TvVdecSampler(mTvSession, property_get_int32("vendor.tv.vdec_sampler.id", 0));
     pthread_mutex_init(&mMutex, NULL);
+    pthread_mutex_init(&mSessionLock, NULL);
+    for (int i = 0; i < TV_STREAM_ROLE_MAX; i++) {
+        pthread_mutex_init(&mRole[i].lock, NULL);
+        resetRole((tv_stream_role_t)i);
+    }
 
 #ifdef SUPPORT_DTVKIT
     sp<IDTVKitServer> dtvkitService = IDTVKitServer::tryGetService();
@@ -72,15 +80,28 @@ TvInputIntf::~TvInputIntf()
 {
     init();
 
+    mVdecSampler->stop();
+    mVdecSampler.clear();
     mTvSession.clear();
 #ifdef SUPPORT_DTVKIT
     if (mDkSession != nullptr) {
         mDkSession.clear();
     }
 #endif
+    for (int i = 0; i < TV_STREAM_ROLE_MAX; i++)
+        pthread_mutex_destroy(&mRole[i].lock);
+    pthread_mutex_destroy(&mSessionLock);
     pthread_mutex_destroy(&mMutex);
 }
 
+void TvInputIntf::resetRole(tv_stream_role_t role)
+{
+    mRole[role].streamGivenId = -1;
+    mRole[role].deviceGivenId = -1;
+    mRole[role].tunnelId = -1;
+    mRole[role].viewId = -1;
+}
+
 void TvInputIntf::init()
 {
     if (mSourceStatus && mSourceInput != SOURCE_INVALID)
@@ -89,15 +110,17 @@ void TvInputIntf::init()
     if (checkHoldSource() != SOURCE_INVALID)
         stopTv(mSourceInput);
 
+    for (int i = 0; i < TV_STREAM_ROLE_MAX; i++) {
+        pthread_mutex_lock(&mRole[i].lock);
+        resetRole((tv_stream_role_t)i);
+        pthread_mutex_unlock(&mRole[i].lock);
+    }
+
     pthread_mutex_lock(&mMutex);
 
-    mStreamGivenId = -1;
-    mDeviceGivenId = -1;
-    mPipStreamGivenId = -1;
-    mPipDeviceGivenId = -1;
     mSourceStatus = false;
     mSourceInput = SOURCE_INVALID;
-    mTunnelId = -1;
+    TV_TRACE_COUNTER("tv.source", SOURCE_INVALID);
 
     while (!start_queue.empty())
         start_queue.pop();
@@ -120,6 +143,12 @@ int TvInputIntf::setTvObserver ( TvPlayObserver *ob )
 
 void TvInputIntf::notify(const tv_parcel_t &parcel)
 {
+    if (parcel.msgType == CLOSE_CAPTION_CALLBACK) {
+        if (mpObserver != NULL)
+            mpObserver->onTvMessage(parcel);
+        return;
+    }
+
     source_connect_t srcConnect;
     srcConnect.msgType = parcel.msgType;
     srcConnect.source = parcel.bodyInt[0];
@@ -132,15 +161,19 @@ void TvInputIntf::notify(const tv_parcel_t &parcel)
 
 int TvInputIntf::startTv(tv_source_input_t source_input)
 {
+    TV_TRACE_CALL();
     int ret = 0;
+    tv_role_context_t *main = &mRole[TV_STREAM_ROLE_MAIN];
 
-    pthread_mutex_lock(&mMutex);
+    pthread_mutex_lock(&main->lock);
 
     ALOGD("startTv source_input: %d.", source_input);
 
+    pthread_mutex_lock(&mMutex);
     setSourceStatus(true);
+    pthread_mutex_unlock(&mMutex);
 
-    if (SOURCE_DTVKIT == source_input || SOURCE_DTVKIT_PIP == source_input) {
+    if (tvSourceTraits(source_input).dtvkit) {
 #ifdef SUPPORT_DTVKIT
         Json::Value json;
         json[0] = "";
@@ -152,33 +185,42 @@ int TvInputIntf::startTv(tv_source_input_t source_input)
 #endif
         ret = 0;
     } else {
-        mTvSession->setTunnelId(mTunnelId);
+        pthread_mutex_lock(&mSessionLock);
+        mTvSession->setTunnelId(main->tunnelId);
         ret = mTvSession->startTv();
-
+        pthread_mutex_unlock(&mSessionLock);
     }
+    if (tvSourceTraits(source_input).demux && mVdecSamplePeriod > 0)
+        mVdecSampler->start(mVdecSamplePeriod);
 
-
-    pthread_mutex_unlock(&mMutex);
+    pthread_mutex_unlock(&main->lock);
 
     return ret;
 }
 
 int TvInputIntf::stopTv(tv_source_input_t source_input)
 {
+    TV_TRACE_CALL();
     int ret = 0;
-
-    pthread_mutex_lock(&mMutex);
+    tv_role_context_t *main = &mRole[TV_STREAM_ROLE_MAIN];
 
     ALOGD("stopTv source_input: %d.", source_input);
 
-    if (source_input != SOURCE_DTVKIT_PIP && (source_input < SOURCE_TV || SOURCE_DTVKIT < source_input)) {
+    if (!tvSourceValid(source_input)) {
         ALOGD("invalid source, return");
         return 0;
     }
 
+    pthread_mutex_lock(&main->lock);
+
+    pthread_mutex_lock(&mMutex);
     setSourceStatus(false);
+    pthread_mutex_unlock(&mMutex);
+
+    if (tvSourceTraits(source_input).demux)
+        mVdecSampler->stop();
 
-    if (SOURCE_DTVKIT == source_input || SOURCE_DTVKIT_PIP == source_input) {
+    if (tvSourceTraits(source_input).dtvkit) {
 #ifdef SUPPORT_DTVKIT
         Json::Value json;
         json[0] = "";
@@ -190,38 +232,45 @@ int TvInputIntf::stopTv(tv_source_input_t source_input)
 #endif
         ret = 0;
     } else {
+        pthread_mutex_lock(&mSessionLock);
         ret = mTvSession->stopTv();
         mTvSession->setTunnelId(-1);
-        mTunnelId = -1;
+        pthread_mutex_unlock(&mSessionLock);
+        main->tunnelId = -1;
     }
-    pthread_mutex_unlock(&mMutex);
+    pthread_mutex_unlock(&main->lock);
 
     return ret;
 }
 
 int TvInputIntf::switchSourceInput(tv_source_input_t source_input)
 {
+    TV_TRACE_CALL();
     int ret = 0;
+    tv_role_context_t *main = &mRole[TV_STREAM_ROLE_MAIN];
 
-    pthread_mutex_lock(&mMutex);
+    pthread_mutex_lock(&main->lock);
 
+    pthread_mutex_lock(&mMutex);
     mSourceInput = source_input;
+    pthread_mutex_unlock(&mMutex);
+    TV_TRACE_COUNTER("tv.source", source_input);
 
     ALOGD("switchSourceInput: %d.", source_input);
 
-    if (SOURCE_DTVKIT == source_input || SOURCE_DTVKIT_PIP == source_input)
+    if (tvSourceTraits(source_input).dtvkit)
         ret = 0;
     else
         ret = mTvSession->switchInputSrc(source_input);
 
-    pthread_mutex_unlock(&mMutex);
+    pthread_mutex_unlock(&main->lock);
 
     return ret;
 }
 
 int TvInputIntf::getSourceConnectStatus(tv_source_input_t source_input)
 {
-    if (SOURCE_DTVKIT == source_input || SOURCE_DTVKIT_PIP == source_input)
+    if (tvSourceTraits(source_input).dtvkit)
         return 0;
     else
         return mTvSession->getInputSrcConnectStatus(source_input);
@@ -231,10 +280,8 @@ int TvInputIntf::getCurrentSourceInput()
 {
     ALOGD("getCurrentSourceInput: mSourceInput %d.", mSourceInput);
 
-    if (mSourceInput == SOURCE_DTVKIT)
-        return SOURCE_DTVKIT;
-    else if (mSourceInput == SOURCE_DTVKIT_PIP)
-        return SOURCE_DTVKIT_PIP;
+    if (tvSourceTraits(mSourceInput).dtvkit)
+        return mSourceInput;
     else
         return mTvSession->getCurrentInputSrc();
 }
@@ -259,7 +306,7 @@ int TvInputIntf::checkSourceStatus(tv_source_input_t source_input, bool check_st
         }
     }
 
-    if (check_status && mSourceStatus && (SOURCE_DTVKIT == source_input || SOURCE_DTVKIT_PIP == source_input))
+    if (check_status && mSourceStatus && tvSourceTraits(source_input).dtvkit)
         hold_queue.push(source_input);
 
     ALOGD("%s [mSourceInput: %d], [switch source_input: %d], [mSourceStatus: %d], [check_status: %d], status: %d (%s).",
@@ -330,67 +377,58 @@ bool TvInputIntf::isTvPlatform()
 
 int TvInputIntf::getStreamGivenId()
 {
-    return mStreamGivenId;
+    return mRole[TV_STREAM_ROLE_MAIN].streamGivenId;
 }
 
 void TvInputIntf::setStreamGivenId(int stream_id)
 {
-    pthread_mutex_lock(&mMutex);
-
-    mStreamGivenId = stream_id;
-
-    pthread_mutex_unlock(&mMutex);
+    mRole[TV_STREAM_ROLE_MAIN].streamGivenId = stream_id;
 }
 
 int TvInputIntf::getDeviceGivenId()
 {
-    return mDeviceGivenId;
+    return mRole[TV_STREAM_ROLE_MAIN].deviceGivenId;
 }
 
 void TvInputIntf::setDeviceGivenId(int device_id)
 {
-    pthread_mutex_lock(&mMutex);
-
-    mDeviceGivenId = device_id;
-
-    pthread_mutex_unlock(&mMutex);
+    mRole[TV_STREAM_ROLE_MAIN].deviceGivenId = device_id;
 }
 
 int TvInputIntf::getPipStreamGivenId()
 {
-    return mPipStreamGivenId;
-
+    return mRole[TV_STREAM_ROLE_PIP].streamGivenId;
 }
 
 void TvInputIntf::setPipStreamGivenId(int stream_id)
 {
-    pthread_mutex_lock(&mMutex);
-
-    mPipStreamGivenId = stream_id;
-
-    pthread_mutex_unlock(&mMutex);
+    mRole[TV_STREAM_ROLE_PIP].streamGivenId = stream_id;
 }
 
 int TvInputIntf::getPipDeviceGivenId()
 {
-    return mPipDeviceGivenId;
-
+    return mRole[TV_STREAM_ROLE_PIP].deviceGivenId;
 }
 
 void TvInputIntf::setPipDeviceGivenId(int device_id)
 {
-    pthread_mutex_lock(&mMutex);
-
-    mPipDeviceGivenId = device_id;
+    mRole[TV_STREAM_ROLE_PIP].deviceGivenId = device_id;
+}
 
-    pthread_mutex_unlock(&mMutex);
+int TvInputIntf::getCaptureDeviceGivenId()
+{
+    return mRole[TV_STREAM_ROLE_CAPTURE].deviceGivenId;
+}
 
+void TvInputIntf::setCaptureGivenId(int device_id, int stream_id)
+{
+    mRole[TV_STREAM_ROLE_CAPTURE].deviceGivenId = device_id;
+    mRole[TV_STREAM_ROLE_CAPTURE].streamGivenId = stream_id;
 }
 
 void TvInputIntf::setStreamTunnelId(int id)
 {
-    mTunnelId = id;
-
+    mRole[TV_STREAM_ROLE_MAIN].tunnelId = id;
 }
 
 int TvInputIntf::getHdmiAvHotplugDetectOnoff()
@@ -448,7 +486,12 @@ bool TvInputIntf::isMultiDemux() {
 int TvInputIntf::writeSurfaceTypetoVpp(tvin_surface_type_t type) {
     char buf[4] = {0};
     snprintf(buf, 4, "%d", type);
-    return writeSys(VPP_SOURCE_TYPE, buf);
+
+    // one vpp for every stream role
+    pthread_mutex_lock(&mMutex);
+    int ret = writeSys(VPP_SOURCE_TYPE, buf);
+    pthread_mutex_unlock(&mMutex);
+    return ret;
 }
 
 int TvInputIntf::writeSys(const char *path, const char *val) {
@@ -469,18 +512,81 @@ int TvInputIntf::writeSys(const char *path, const char *val) {
     return 0;
 }
 
-int TvInputIntf::StartTvInPIP( int32_t source_input ) {
-    return  mTvSession->StartTvInPIP(source_input);
+/*
+ * tvserver has a single PIP path and its stop takes no source, so the view
+ * that started it owns it until that view stops it.  Another view gets -EBUSY
+ * instead of taking the path over, and a stop from a view that does not own
+ * it leaves the running PIP alone.
+ */
+int TvInputIntf::StartTvInPIP(int32_t source_input, int view_id) {
+    TV_TRACE_CALL();
+    tv_role_context_t *pip = &mRole[TV_STREAM_ROLE_PIP];
+    int ret = 0;
+
+    pthread_mutex_lock(&pip->lock);
+    if (pip->viewId >= 0 && pip->viewId != view_id) {
+        ALOGW("pip is owned by view %d, view %d of source %d rejected", pip->viewId.load(), view_id,
+                source_input);
+        pthread_mutex_unlock(&pip->lock);
+        return -EBUSY;
+    }
+
+    ret = mTvSession->StartTvInPIP(source_input);
+
+    if (ret >= 0) {
+        pip->viewId = view_id;
+        pip->deviceGivenId = source_input;
+    }
+    pthread_mutex_unlock(&pip->lock);
+    return ret;
+}
+
+int TvInputIntf::StopTvInPIP(int view_id) {
+    TV_TRACE_CALL();
+    tv_role_context_t *pip = &mRole[TV_STREAM_ROLE_PIP];
+    int ret = 0;
+
+    pthread_mutex_lock(&pip->lock);
+    if (pip->viewId != view_id) {
+        ALOGD("view %d doesn't own pip (owner %d), nothing to stop", view_id, pip->viewId.load());
+        pthread_mutex_unlock(&pip->lock);
+        return 0;
+    }
+
+    ret = mTvSession->StopTvInPIP();
+
+    resetRole(TV_STREAM_ROLE_PIP);
+    pthread_mutex_unlock(&pip->lock);
+    return ret;
+}
+
+bool TvInputIntf::isSupportPIP() {
+    return mTvSession->IsSupportPIP() == 1;
 }
 
-int TvInputIntf::StopTvInPIP() {
-    return mTvSession->StopTvInPIP();
+int TvInputIntf::getVdecStats(nsecs_t window, tv_vdec_stats_t *stats) {
+    return mVdecSampler->getStats(window, stats);
+}
+
+// no locks, a start/stop in progress holds the role lock for seconds
+void TvInputIntf::dump(int fd) {
+    static const char *kRoleNames[TV_STREAM_ROLE_MAX] = { "main", "pip", "capture" };
+
+    dprintf(fd, "source %d %s, %s platform\n", mSourceInput, mSourceStatus ? "started" : "stopped",
+            mIsTv ? "tv" : "box");
+    for (int i = 0; i < TV_STREAM_ROLE_MAX; i++) {
+        dprintf(fd, "  %s: device %d stream %d tunnel %d view %d\n", kRoleNames[i],
+                mRole[i].deviceGivenId.load(), mRole[i].streamGivenId.load(),
+                mRole[i].tunnelId.load(), mRole[i].viewId.load());
+    }
+    mTvSession->dump(fd);
+    mVdecSampler->dump(fd);
 }
 
 bool TvInputIntf::IsHdmiPIP(int32_t source_input ) {
     bool ret = false;
      //PIP Include av & hdmi
-    if ((tv_source_input_t)source_input < SOURCE_VGA &&
+    if (tvSourceTraits(source_input).pip_capable &&
         1 == mTvSession->IsSupportPIP()) {
         ret = true;
      }
@@ -24,10 +24,15 @@
 
 #include <pthread.h>
 #include <semaphore.h>
+#include <atomic>
 #include <queue>
 #include <unistd.h>
 
 #include "TvServerHidlClient.h"
+#include "TvVdecSampler.h"
+#ifdef SUPPORT_DTVKIT
+#include "DTVKitHidlClient.h"
+#endif
 
 using namespace android;
 
@@ -72,11 +77,38 @@ typedef struct source_connect_s {
     int state;
 } source_connect_t;
 
+/*
+ * Main and PIP run on independent tunnels, so each stream role serializes
+ * only its own start/stop and a PIP start overlaps a main start.  The tunnel
+ * id is tvserver session state that only the main start/stop uses, so its
+ * setTunnelId() and the startTv()/stopTv() that uses it run under
+ * mSessionLock; the PIP calls take no tunnel and don't take it.  Source
+ * arbitration (the wait/hold queues, current source and status) and the VPP
+ * surface type are shared and stay under mMutex.  Lock order is role lock,
+ * mSessionLock, then mMutex.  The given ids are atomics so the getters and
+ * setters never wait for a start in progress.
+ */
+typedef enum tv_stream_role_e {
+    TV_STREAM_ROLE_MAIN = 0,
+    TV_STREAM_ROLE_PIP,
+    TV_STREAM_ROLE_CAPTURE,
+    TV_STREAM_ROLE_MAX,
+} tv_stream_role_t;
+
+typedef struct tv_role_context_s {
+    pthread_mutex_t lock;
+    std::atomic<int> streamGivenId;
+    std::atomic<int> deviceGivenId;
+    std::atomic<int> tunnelId;
+    std::atomic<int> viewId;            /* view that started the role, -1 if free */
+} tv_role_context_t;
+
 class TvPlayObserver {
 public:
     TvPlayObserver() {};
     virtual ~TvPlayObserver() {};
     virtual void onTvEvent (const source_connect_t &scrConnect) = 0;
+    virtual void onTvMessage (const tv_parcel_t &parcel __unused) {};
 };
 
 class TvInputIntf : public TvListener {
@@ -103,6 +135,8 @@ public:
     void setPipStreamGivenId(int stream_id);
     int getPipDeviceGivenId();
     void setPipDeviceGivenId(int device_id);
+    int getCaptureDeviceGivenId();
+    void setCaptureGivenId(int device_id, int stream_id);
     int getHdmiAvHotplugDetectOnoff();
     int setTvObserver (TvPlayObserver *ob);
     int getSupportInputDevices(int *devices, int *count);
@@ -111,24 +145,31 @@ public:
     virtual void notify(const tv_parcel_t &parcel);
     int writeSurfaceTypetoVpp(tvin_surface_type_t type);
     void setStreamTunnelId(int id);
-    int StartTvInPIP( int32_t source_input );
-    int StopTvInPIP();
+    int StartTvInPIP(int32_t source_input, int view_id);
+    int StopTvInPIP(int view_id);
     bool IsHdmiPIP(int32_t source_input);
+    bool isSupportPIP();
+    int getVdecStats(nsecs_t window, tv_vdec_stats_t *stats);
+    void dump(int fd);
 
 private:
+    void resetRole(tv_stream_role_t role);
+
     pthread_mutex_t mMutex;
-    int mStreamGivenId;
-    int mDeviceGivenId;
-    int mPipStreamGivenId;
-    int mPipDeviceGivenId;
+    pthread_mutex_t mSessionLock;
+    tv_role_context_t mRole[TV_STREAM_ROLE_MAX];
     bool mSourceStatus;
     bool mIsTv;
-    int mTunnelId;
     std::queue<tv_source_input_t> start_queue;
     std::queue<tv_source_input_t> stop_queue;
     std::queue<tv_source_input_t> hold_queue;
     tv_source_input_t mSourceInput;
     sp<TvServerHidlClient> mTvSession;
+    sp<TvVdecSampler> mVdecSampler;
+    nsecs_t mVdecSamplePeriod;
+#ifdef SUPPORT_DTVKIT
+    sp<DTVKitHidlClient> mDkSession;
+#endif
     int writeSys(const char *path, const char *val);
     TvPlayObserver *mpObserver;
 };
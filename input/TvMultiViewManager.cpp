@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 bookkeeping and admission of concurrently shown tv streams
+ */
+
+#define LOG_TAG "TvMultiViewManager"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <utils/Log.h>
+#include <cutils/properties.h>
+
+#include "TvSourceTraits.h"
+#include "TvMultiViewManager.h"
+#include "tv_input.h"
+
+#define MULTIVIEW_DEFAULT_PIXELS (2LL * 1920 * 1080)
+
+TvMultiViewManager::TvMultiViewManager(TvInputIntf *tv, TvTunnelAllocator *tunnels)
+    : mTunnels(tunnels),
+      mNextViewId(0)
+{
+    pthread_mutex_init(&mMutex, NULL);
+    initCaps(tv);
+}
+
+TvMultiViewManager::~TvMultiViewManager()
+{
+    pthread_mutex_lock(&mMutex);
+    for (std::map<ViewKey, tv_view_t>::iterator it = mViews.begin(); it != mViews.end(); ++it)
+        destroyView(&it->second);
+    mViews.clear();
+    pthread_mutex_unlock(&mMutex);
+
+    pthread_mutex_destroy(&mMutex);
+}
+
+/*
+ * Defaults describe what the fixed main + PIP setup always allowed: a second
+ * vdin path only when tvserver supports hdmi/av PIP, and dtv main + dtvkit
+ * PIP on the decoder side.  SoCs with more paths raise them by property, but
+ * tvserver drives a single PIP path, so the vdin paths are clamped to main +
+ * that one whatever the property says; otherwise a view would be admitted
+ * and then fail to start.
+ */
+void TvMultiViewManager::initCaps(TvInputIntf *tv)
+{
+    int vdinPaths = tv->isSupportPIP() ? 2 : 1;
+
+    int vdinProp = property_get_int32(MULTIVIEW_VDIN_PATHS_PROP, vdinPaths);
+    if (vdinProp > vdinPaths)
+        ALOGW("%s %d, tvserver drives only %d vdin paths", MULTIVIEW_VDIN_PATHS_PROP, vdinProp, vdinPaths);
+    mCaps.paths[TV_VIEW_PATH_VDIN] = vdinProp < vdinPaths ? vdinProp : vdinPaths;
+    mCaps.paths[TV_VIEW_PATH_DECODER] = property_get_int32(MULTIVIEW_DECODER_PATHS_PROP, 2);
+    mCaps.maxViews = property_get_int32(MULTIVIEW_MAX_VIEWS_PROP, 2);
+    int pathCount = mCaps.paths[TV_VIEW_PATH_VDIN] + mCaps.paths[TV_VIEW_PATH_DECODER];
+    if (mCaps.maxViews > pathCount)
+        mCaps.maxViews = pathCount;
+    mCaps.maxPixels = property_get_int64(MULTIVIEW_MAX_PIXELS_PROP, MULTIVIEW_DEFAULT_PIXELS);
+
+    ALOGI("multi view caps: vdin %d, decoder %d, views %d, pixels %lld",
+            mCaps.paths[TV_VIEW_PATH_VDIN], mCaps.paths[TV_VIEW_PATH_DECODER],
+            mCaps.maxViews, (long long)mCaps.maxPixels);
+}
+
+void TvMultiViewManager::getCaps(tv_multiview_caps_t *caps)
+{
+    pthread_mutex_lock(&mMutex);
+    *caps = mCaps;
+    pthread_mutex_unlock(&mMutex);
+}
+
+tv_view_admit_t TvMultiViewManager::admit(int device_id, int stream_id, int width, int height, int tunnel_id,
+        int *view_id)
+{
+    tv_view_t view;
+    memset(&view, 0, sizeof(view));
+    view.device_id = device_id;
+    view.stream_id = stream_id;
+    view.path = pathOf(device_id);
+    view.width = width;
+    view.height = height;
+    view.main = isMainStream(stream_id);
+    view.tunnel_id = tunnel_id;
+
+    pthread_mutex_lock(&mMutex);
+
+    ViewKey key(device_id, stream_id);
+    view.view_id = mNextViewId;
+
+    // only one main window, switching it replaces the previous one
+    if (view.main) {
+        for (std::map<ViewKey, tv_view_t>::iterator it = mViews.begin(); it != mViews.end();) {
+            if (it->second.main) {
+                destroyView(&it->second);
+                it = mViews.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        mViews[key] = view;
+        mNextViewId = (mNextViewId + 1) & INT32_MAX;
+        pthread_mutex_unlock(&mMutex);
+        if (view_id != NULL)
+            *view_id = view.view_id;
+        return TV_VIEW_ADMIT;
+    }
+
+    if (mViews.find(key) != mViews.end()) {
+        pthread_mutex_unlock(&mMutex);
+        return TV_VIEW_REJECT;
+    }
+
+    int views = 0;
+    int paths = 0;
+    int64_t pixels = 0;
+    for (std::map<ViewKey, tv_view_t>::iterator it = mViews.begin(); it != mViews.end(); ++it) {
+        const tv_view_t &other = it->second;
+        views++;
+        if (other.path == view.path)
+            paths++;
+        pixels += (int64_t)other.width * other.height;
+        if (tunnel_id >= 0 && other.tunnel_id == tunnel_id) {
+            ALOGW("view %d/%d: tunnel %d is used by %d/%d", device_id, stream_id, tunnel_id,
+                    other.device_id, other.stream_id);
+            pthread_mutex_unlock(&mMutex);
+            return TV_VIEW_REJECT;
+        }
+    }
+
+    tv_view_admit_t result = TV_VIEW_ADMIT;
+    if (views >= mCaps.maxViews || paths >= mCaps.paths[view.path]) {
+        ALOGW("view %d/%d: no %s path left (%d views, %d/%d paths)", device_id, stream_id,
+                view.path == TV_VIEW_PATH_VDIN ? "vdin" : "decoder", views, paths, mCaps.paths[view.path]);
+        result = TV_VIEW_REJECT;
+    } else if (pixels + (int64_t)width * height > mCaps.maxPixels) {
+        ALOGW("view %d/%d: pixel budget %lld exhausted", device_id, stream_id, (long long)mCaps.maxPixels);
+        result = TV_VIEW_REJECT;
+    }
+
+    if (result == TV_VIEW_ADMIT) {
+        mViews[key] = view;
+        mNextViewId = (mNextViewId + 1) & INT32_MAX;
+        if (view_id != NULL)
+            *view_id = view.view_id;
+    }
+
+    pthread_mutex_unlock(&mMutex);
+
+    ALOGD("view %d/%d %dx%d tunnel %d: %s, id %d", device_id, stream_id, view.width, view.height, tunnel_id,
+            result == TV_VIEW_ADMIT ? "admit" : "reject", view.view_id);
+    return result;
+}
+
+bool TvMultiViewManager::getView(int device_id, int stream_id, tv_view_t *view)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&mMutex);
+    std::map<ViewKey, tv_view_t>::iterator it = mViews.find(ViewKey(device_id, stream_id));
+    if (it != mViews.end()) {
+        *view = it->second;
+        found = true;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return found;
+}
+
+int TvMultiViewManager::setTunnel(int device_id, int stream_id, int tunnel_id)
+{
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+    std::map<ViewKey, tv_view_t>::iterator it = mViews.find(ViewKey(device_id, stream_id));
+    if (it != mViews.end() && it->second.tunnel_id < 0) {
+        it->second.tunnel_id = tunnel_id;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
+
+int TvMultiViewManager::release(int device_id, int stream_id)
+{
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+    std::map<ViewKey, tv_view_t>::iterator it = mViews.find(ViewKey(device_id, stream_id));
+    if (it != mViews.end()) {
+        destroyView(&it->second);
+        mViews.erase(it);
+        ret = 0;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
+
+int TvMultiViewManager::count()
+{
+    pthread_mutex_lock(&mMutex);
+    int views = mViews.size();
+    pthread_mutex_unlock(&mMutex);
+
+    return views;
+}
+
+void TvMultiViewManager::dump(int fd)
+{
+    pthread_mutex_lock(&mMutex);
+    dprintf(fd, "views %zu, caps: vdin %d decoder %d paths, max %d views %" PRId64 " pixels\n", mViews.size(),
+            mCaps.paths[TV_VIEW_PATH_VDIN], mCaps.paths[TV_VIEW_PATH_DECODER], mCaps.maxViews, mCaps.maxPixels);
+    dprintf(fd, "  vdin paths capped at main + 1 pip, tvserver has no n-way pip\n");
+    for (std::map<ViewKey, tv_view_t>::iterator it = mViews.begin(); it != mViews.end(); ++it) {
+        const tv_view_t &view = it->second;
+        dprintf(fd, "  %d/%d: view %d %s %dx%d%s tunnel %d\n", view.device_id, view.stream_id,
+                view.view_id, view.path == TV_VIEW_PATH_DECODER ? "decoder" : "vdin", view.width,
+                view.height, view.main ? " main" : "", view.tunnel_id);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
+tv_view_path_t TvMultiViewManager::pathOf(int device_id)
+{
+    const tv_source_traits_t &traits = tvSourceTraits(device_id);
+    return (traits.dtvkit || traits.demux) ? TV_VIEW_PATH_DECODER : TV_VIEW_PATH_VDIN;
+}
+
+bool TvMultiViewManager::isMainStream(int stream_id)
+{
+    return stream_id == STREAM_ID_NORMAL || stream_id == STREAM_ID_MAIN;
+}
+
+void TvMultiViewManager::destroyView(tv_view_t *view)
+{
+    if (view->tunnel_id >= 0) {
+        mTunnels->release(view->tunnel_id);
+        view->tunnel_id = -1;
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 bookkeeping and admission of concurrently shown tv streams
+ */
+
+#ifndef _ANDROID_TV_MULTI_VIEW_MANAGER_H_
+#define _ANDROID_TV_MULTI_VIEW_MANAGER_H_
+
+#include <pthread.h>
+#include <map>
+#include <utility>
+
+#include "TvInputIntf.h"
+#include "TvTunnelAllocator.h"
+
+#define MULTIVIEW_VDIN_PATHS_PROP    "vendor.tv.multiview.vdin_paths"
+#define MULTIVIEW_DECODER_PATHS_PROP "vendor.tv.multiview.decoder_paths"
+#define MULTIVIEW_MAX_VIEWS_PROP     "vendor.tv.multiview.max_views"
+#define MULTIVIEW_MAX_PIXELS_PROP    "vendor.tv.multiview.max_pixels"
+
+typedef enum tv_view_path_e {
+    TV_VIEW_PATH_VDIN = 0,      /* atv, av, hdmi ... captured by vdin */
+    TV_VIEW_PATH_DECODER,       /* dtv played through the demux and decoder */
+    TV_VIEW_PATH_MAX,
+} tv_view_path_t;
+
+typedef enum tv_view_admit_e {
+    TV_VIEW_ADMIT = 0,
+    TV_VIEW_REJECT,
+} tv_view_admit_t;
+
+typedef struct tv_multiview_caps_s {
+    int paths[TV_VIEW_PATH_MAX];
+    int maxViews;
+    int64_t maxPixels;
+} tv_multiview_caps_t;
+
+typedef struct tv_view_s {
+    int view_id;                /* unique per admitted view, owns its start/stop */
+    int device_id;
+    int stream_id;
+    tv_view_path_t path;
+    int width;                  /* configured size of the stream */
+    int height;
+    bool main;
+    int tunnel_id;              /* reference owned by the view, -1 if none */
+} tv_view_t;
+
+/*
+ * Every opened video stream is a view keyed by (device_id, stream_id) and
+ * gets its own view_id, which the start/stop of its source is tied to.  The
+ * main window is always admitted and replaces the previous main view, the
+ * other views (PIP, grids) are admitted while a vdin/decoder path and pixel
+ * budget are left, otherwise rejected; the sideband has no way to scale a
+ * view, so nothing is admitted below its configured size.  tvserver has a
+ * single PIP path, so at most main + one vdin PIP view are admitted even when
+ * the SoC has more vdin paths; a 2x2 grid of vdin sources is not possible.
+ * Tunnels given to admit() or setTunnel() are released to the allocator with
+ * it.
+ */
+class TvMultiViewManager {
+public:
+    TvMultiViewManager(TvInputIntf *tv, TvTunnelAllocator *tunnels);
+    ~TvMultiViewManager();
+
+    void getCaps(tv_multiview_caps_t *caps);
+    tv_view_admit_t admit(int device_id, int stream_id, int width, int height, int tunnel_id,
+            int *view_id);
+    bool getView(int device_id, int stream_id, tv_view_t *view);
+    int setTunnel(int device_id, int stream_id, int tunnel_id);
+    int release(int device_id, int stream_id);
+    int count();
+    void dump(int fd);
+
+private:
+    typedef std::pair<int, int> ViewKey;
+
+    static tv_view_path_t pathOf(int device_id);
+    static bool isMainStream(int stream_id);
+    void destroyView(tv_view_t *view);
+    void initCaps(TvInputIntf *tv);
+
+    TvTunnelAllocator *mTunnels;
+    pthread_mutex_t mMutex;
+    tv_multiview_caps_t mCaps;
+    std::map<ViewKey, tv_view_t> mViews;
+    int mNextViewId;
+};
+
+#endif/*_ANDROID_TV_MULTI_VIEW_MANAGER_H_*/
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 static properties of every tv_source_input_t
+ */
+
+#ifndef _ANDROID_TV_SOURCE_TRAITS_H_
+#define _ANDROID_TV_SOURCE_TRAITS_H_
+
+#include <stdint.h>
+#include <system/audio.h>
+#include <hardware/tv_input.h>
+
+#include "TvInputIntf.h"
+
+/* how the aidl layer describes the audio device of a source */
+typedef enum tv_audio_connection_e {
+    TV_AUDIO_CONNECTION_NONE = 0,
+    TV_AUDIO_CONNECTION_TUNER,
+    TV_AUDIO_CONNECTION_ANALOG,
+    TV_AUDIO_CONNECTION_HDMI,
+    TV_AUDIO_CONNECTION_HDMI_ARC,
+    TV_AUDIO_CONNECTION_SPDIF,
+} tv_audio_connection_t;
+
+typedef struct tv_source_traits_s {
+    tv_source_input_t source;
+    tv_input_type_t type;
+    audio_devices_t audio_type;
+    tv_audio_connection_t audio_connection;
+    tvin_surface_type_t surface_type;
+    int hdmi_port;          /* 1..4 for hdmi, 0 otherwise */
+    bool pip_capable;       /* can be started in the tvserver (vdin) PIP window */
+    bool hotplug;           /* reports cable connect status */
+    bool demux;             /* fed by the demux, uses the dtv tunnel */
+    bool dtvkit;            /* played by dtvkit instead of tvserver */
+} tv_source_traits_t;
+
+/* SOURCE_DTVKIT_PIP is stored right after the real sources */
+#define TV_SOURCE_TRAITS_COUNT (SOURCE_MAX + 1)
+
+static constexpr tv_source_traits_t kTvSourceTraits[TV_SOURCE_TRAITS_COUNT] = {
+    {SOURCE_TV,     TV_INPUT_TYPE_TUNER,          AUDIO_DEVICE_IN_TV_TUNER, TV_AUDIO_CONNECTION_TUNER,    TVIN_SOURCE_TYPE_VDIN,    0, true,  false, false, false},
+    {SOURCE_AV1,    TV_INPUT_TYPE_COMPOSITE,      AUDIO_DEVICE_IN_LINE,     TV_AUDIO_CONNECTION_ANALOG,   TVIN_SOURCE_TYPE_VDIN,    0, true,  true,  false, false},
+    {SOURCE_AV2,    TV_INPUT_TYPE_COMPOSITE,      AUDIO_DEVICE_IN_LINE,     TV_AUDIO_CONNECTION_ANALOG,   TVIN_SOURCE_TYPE_VDIN,    0, true,  true,  false, false},
+    {SOURCE_YPBPR1, TV_INPUT_TYPE_COMPONENT,      AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, true,  true,  false, false},
+    {SOURCE_YPBPR2, TV_INPUT_TYPE_COMPONENT,      AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, true,  true,  false, false},
+    {SOURCE_HDMI1,  TV_INPUT_TYPE_HDMI,           AUDIO_DEVICE_IN_HDMI,     TV_AUDIO_CONNECTION_HDMI,     TVIN_SOURCE_TYPE_VDIN,    1, true,  true,  false, false},
+    {SOURCE_HDMI2,  TV_INPUT_TYPE_HDMI,           AUDIO_DEVICE_IN_HDMI,     TV_AUDIO_CONNECTION_HDMI,     TVIN_SOURCE_TYPE_VDIN,    2, true,  true,  false, false},
+    {SOURCE_HDMI3,  TV_INPUT_TYPE_HDMI,           AUDIO_DEVICE_IN_HDMI,     TV_AUDIO_CONNECTION_HDMI,     TVIN_SOURCE_TYPE_VDIN,    3, true,  true,  false, false},
+    {SOURCE_HDMI4,  TV_INPUT_TYPE_HDMI,           AUDIO_DEVICE_IN_HDMI,     TV_AUDIO_CONNECTION_HDMI,     TVIN_SOURCE_TYPE_VDIN,    4, true,  true,  false, false},
+    {SOURCE_VGA,    TV_INPUT_TYPE_VGA,            AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_MPEG,   TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_DTV,    TV_INPUT_TYPE_TUNER,          AUDIO_DEVICE_IN_TV_TUNER, TV_AUDIO_CONNECTION_TUNER,    TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_SVIDEO, TV_INPUT_TYPE_SVIDEO,         AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_IPTV,   TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_DUMMY,  TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_NONE,        TV_AUDIO_CONNECTION_NONE,     TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_SPDIF,  TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_IN_SPDIF,    TV_AUDIO_CONNECTION_SPDIF,    TVIN_SOURCE_TYPE_VDIN,    0, false, false, false, false},
+    {SOURCE_ADTV,   TV_INPUT_TYPE_TUNER,          AUDIO_DEVICE_IN_TV_TUNER, TV_AUDIO_CONNECTION_TUNER,    TVIN_SOURCE_TYPE_OTHERS,  0, false, false, true,  false},
+    {SOURCE_AUX,    TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_IN_LINE,     TV_AUDIO_CONNECTION_ANALOG,   TVIN_SOURCE_TYPE_OTHERS,  0, false, false, false, false},
+    {SOURCE_ARC,    TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_IN_HDMI_ARC, TV_AUDIO_CONNECTION_HDMI_ARC, TVIN_SOURCE_TYPE_OTHERS,  0, false, false, false, false},
+    {SOURCE_DTVKIT, TV_INPUT_TYPE_TUNER,          AUDIO_DEVICE_IN_TV_TUNER, TV_AUDIO_CONNECTION_TUNER,    TVIN_SOURCE_TYPE_DECODER, 0, false, false, true,  true},
+    {SOURCE_DTVKIT_PIP, TV_INPUT_TYPE_TUNER,      AUDIO_DEVICE_IN_TV_TUNER, TV_AUDIO_CONNECTION_TUNER,    TVIN_SOURCE_TYPE_OTHERS,  0, false, false, false, true},
+};
+
+/* returned for ids outside the table, matches the old switch default cases */
+static constexpr tv_source_traits_t kTvSourceTraitsInvalid = {
+    SOURCE_INVALID, TV_INPUT_TYPE_OTHER_HARDWARE, AUDIO_DEVICE_NONE, TV_AUDIO_CONNECTION_NONE,
+    TVIN_SOURCE_TYPE_OTHERS, 0, false, false, false, false
+};
+
+static constexpr int tvSourceSlot(int source)
+{
+    return source == SOURCE_DTVKIT_PIP ? SOURCE_MAX
+            : (source >= SOURCE_TV && source < SOURCE_MAX ? source : -1);
+}
+
+static constexpr bool tvSourceTraitsOrdered(int i = 0)
+{
+    return i == TV_SOURCE_TRAITS_COUNT ||
+            (tvSourceSlot(kTvSourceTraits[i].source) == i && tvSourceTraitsOrdered(i + 1));
+}
+static_assert(tvSourceTraitsOrdered(), "kTvSourceTraits must be indexed by tvSourceSlot()");
+
+static constexpr const tv_source_traits_t &tvSourceTraits(int source)
+{
+    return tvSourceSlot(source) < 0 ? kTvSourceTraitsInvalid : kTvSourceTraits[tvSourceSlot(source)];
+}
+
+static constexpr bool tvSourceValid(int source)
+{
+    return tvSourceSlot(source) >= 0;
+}
+
+#endif/*_ANDROID_TV_SOURCE_TRAITS_H_*/
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 owns the sideband handles of the opened tv streams
+ */
+
+#define LOG_TAG "TvStreamRegistry"
+
+#include <errno.h>
+#include <stdio.h>
+#include <utils/Log.h>
+#include <amlogic/am_gralloc_ext.h>
+
+#include "TvStreamRegistry.h"
+
+static size_t handleBytes(const native_handle_t *handle)
+{
+    return sizeof(native_handle_t) + sizeof(int) * (handle->numFds + handle->numInts);
+}
+
+TvStreamRegistry::TvStreamRegistry(TvTunnelAllocator *tunnels)
+    : mTunnels(tunnels)
+{
+    pthread_mutex_init(&mMutex, NULL);
+}
+
+TvStreamRegistry::~TvStreamRegistry()
+{
+    pthread_mutex_lock(&mMutex);
+    while (!mStreams.empty()) {
+        std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.begin();
+        stream_handle_t *entry = it->second;
+        mStreams.erase(it);
+        unref(entry);
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    pthread_mutex_destroy(&mMutex);
+}
+
+TvStreamRegistry::stream_handle_t *TvStreamRegistry::create(tv_stream_slot_t slot, int type, int tunnel_id)
+{
+    native_handle_t *handle = am_gralloc_create_sideband_handle(type, type == AM_FIXED_TUNNEL ? tunnel_id : 1);
+    if (handle == NULL)
+        return NULL;
+
+    stream_handle_t *entry = new stream_handle_t;
+    entry->handle = handle;
+    entry->slot = slot;
+    entry->type = type;
+    entry->tunnel_id = -1;
+    entry->refs = 0;
+    // the handle keeps its tunnel until destroyed, even after the view is gone
+    if (type == AM_FIXED_TUNNEL && mTunnels->retain(tunnel_id) > 0)
+        entry->tunnel_id = tunnel_id;
+    if (slot != TV_STREAM_SLOT_PRIVATE)
+        mSlots[slot] = entry;
+    return entry;
+}
+
+void TvStreamRegistry::unref(stream_handle_t *entry)
+{
+    if (--entry->refs > 0)
+        return;
+
+    ALOGD("destroy sideband handle, slot %d tunnel %d", entry->slot, entry->tunnel_id);
+    if (entry->slot != TV_STREAM_SLOT_PRIVATE)
+        mSlots.erase(entry->slot);
+    am_gralloc_destroy_sideband_handle(entry->handle);
+    if (entry->tunnel_id >= 0)
+        mTunnels->release(entry->tunnel_id);
+    delete entry;
+}
+
+native_handle_t *TvStreamRegistry::acquire(int device_id, int stream_id, tv_stream_slot_t slot, int type, int tunnel_id)
+{
+    native_handle_t *handle = NULL;
+
+    pthread_mutex_lock(&mMutex);
+    StreamKey key(device_id, stream_id);
+    std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.find(key);
+    if (it != mStreams.end()) {
+        handle = it->second->handle;
+        pthread_mutex_unlock(&mMutex);
+        return handle;
+    }
+
+    stream_handle_t *entry = NULL;
+    if (slot != TV_STREAM_SLOT_PRIVATE) {
+        std::map<int, stream_handle_t *>::iterator shared = mSlots.find(slot);
+        if (shared != mSlots.end())
+            entry = shared->second;
+    }
+    if (entry == NULL)
+        entry = create(slot, type, tunnel_id);
+
+    if (entry != NULL) {
+        entry->refs++;
+        mStreams[key] = entry;
+        handle = entry->handle;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    if (handle == NULL)
+        ALOGE("sideband handle of %d/%d can not be created", device_id, stream_id);
+    return handle;
+}
+
+native_handle_t *TvStreamRegistry::get(int device_id, int stream_id)
+{
+    native_handle_t *handle = NULL;
+
+    pthread_mutex_lock(&mMutex);
+    std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.find(StreamKey(device_id, stream_id));
+    if (it != mStreams.end())
+        handle = it->second->handle;
+    pthread_mutex_unlock(&mMutex);
+
+    return handle;
+}
+
+int TvStreamRegistry::release(int device_id, int stream_id)
+{
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+    std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.find(StreamKey(device_id, stream_id));
+    if (it != mStreams.end()) {
+        stream_handle_t *entry = it->second;
+        mStreams.erase(it);
+        unref(entry);
+        ret = 0;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
+
+void TvStreamRegistry::getStats(tv_stream_stats_t *stats)
+{
+    std::map<stream_handle_t *, int> handles;
+
+    pthread_mutex_lock(&mMutex);
+    stats->streams = mStreams.size();
+    for (std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.begin(); it != mStreams.end(); ++it)
+        handles[it->second]++;
+    stats->handles = handles.size();
+    stats->fds = 0;
+    stats->bytes = 0;
+    for (std::map<stream_handle_t *, int>::iterator it = handles.begin(); it != handles.end(); ++it) {
+        stats->fds += it->first->handle->numFds;
+        stats->bytes += handleBytes(it->first->handle);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
+void TvStreamRegistry::dump(int fd)
+{
+    tv_stream_stats_t stats;
+    getStats(&stats);
+
+    pthread_mutex_lock(&mMutex);
+    dprintf(fd, "streams %d, handles %d, fds %d, %zu bytes:\n", stats.streams, stats.handles, stats.fds, stats.bytes);
+    for (std::map<StreamKey, stream_handle_t *>::iterator it = mStreams.begin(); it != mStreams.end(); ++it) {
+        const stream_handle_t *entry = it->second;
+        dprintf(fd, "  %d/%d: handle %p slot %d type %d tunnel %d, %d refs\n", it->first.first, it->first.second,
+                entry->handle, entry->slot, entry->type, entry->tunnel_id, entry->refs);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 owns the sideband handles of the opened tv streams
+ */
+
+#ifndef _ANDROID_TV_STREAM_REGISTRY_H_
+#define _ANDROID_TV_STREAM_REGISTRY_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <map>
+#include <utility>
+
+#include <cutils/native_handle.h>
+
+#include "TvTunnelAllocator.h"
+
+/*
+ * Streams bound to the same slot share one handle, the main window keeps its
+ * handle while the source behind it changes.  PRIVATE streams get their own.
+ */
+typedef enum tv_stream_slot_e {
+    TV_STREAM_SLOT_PRIVATE = -1,
+    TV_STREAM_SLOT_FIXED = 0,       /* vendor.tv.fixed_tunnel=0, one handle for all */
+    TV_STREAM_SLOT_NORMAL,
+    TV_STREAM_SLOT_MAIN,
+} tv_stream_slot_t;
+
+typedef struct tv_stream_stats_s {
+    int streams;                    /* opened (device_id, stream_id) keys */
+    int handles;
+    int fds;
+    size_t bytes;                   /* native_handle_t allocations */
+} tv_stream_stats_t;
+
+/*
+ * Every opened (device_id, stream_id) holds one reference on its handle, a
+ * handle is destroyed with am_gralloc_destroy_sideband_handle() once the last
+ * stream using it is released.  Opening the same key twice returns the same
+ * handle without a new reference, so handles are bounded by the keys.
+ * Handles on a fixed tunnel retain the tunnel for their whole lifetime.
+ */
+class TvStreamRegistry {
+public:
+    TvStreamRegistry(TvTunnelAllocator *tunnels);
+    ~TvStreamRegistry();
+
+    native_handle_t *acquire(int device_id, int stream_id, tv_stream_slot_t slot, int type, int tunnel_id);
+    native_handle_t *get(int device_id, int stream_id);
+    int release(int device_id, int stream_id);
+    void getStats(tv_stream_stats_t *stats);
+    void dump(int fd);
+
+private:
+    typedef std::pair<int, int> StreamKey;
+
+    typedef struct stream_handle_s {
+        native_handle_t *handle;
+        tv_stream_slot_t slot;
+        int type;
+        int tunnel_id;
+        int refs;
+    } stream_handle_t;
+
+    stream_handle_t *create(tv_stream_slot_t slot, int type, int tunnel_id);
+    void unref(stream_handle_t *entry);
+
+    TvTunnelAllocator *mTunnels;
+    pthread_mutex_t mMutex;
+    std::map<StreamKey, stream_handle_t *> mStreams;
+    std::map<int, stream_handle_t *> mSlots;
+};
+
+#endif/*_ANDROID_TV_STREAM_REGISTRY_H_*/
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 low resolution preview thumbnails of the tv inputs
+ */
+
+#define LOG_TAG "TvThumbnailService"
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <utils/Log.h>
+#include <utils/Timers.h>
+#include <cutils/ashmem.h>
+#include <cutils/properties.h>
+
+#include "TvInputIntf.h"
+#include "TvThumbnailService.h"
+
+#define THUMBNAIL_STRIDE (TV_THUMBNAIL_WIDTH * 2)
+#define THUMBNAIL_BYTES  (THUMBNAIL_STRIDE * TV_THUMBNAIL_HEIGHT)
+
+static_assert(TV_THUMBNAIL_SLOTS == SOURCE_MAX + 1, "one thumbnail slot per source plus dtvkit pip");
+
+TvThumbnailService::TvThumbnailService(TvFrameGrabber *grabber, ActiveSourceHandler active, void *data)
+    : mGrabber(grabber),
+      mActive(active),
+      mData(data),
+      mFd(-1),
+      mSize(0),
+      mBase(NULL),
+      mScratch(NULL),
+      mSlotSize(0),
+      mThreadStarted(false),
+      mExit(false),
+      mRefresh(false),
+      mInUse(false)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&mMutex, NULL);
+    pthread_cond_init(&mCond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    mIntervalMs = property_get_int32(TV_THUMBNAIL_INTERVAL_PROP, TV_THUMBNAIL_INTERVAL_DEFAULT);
+
+    mSlotSize = (sizeof(tv_thumbnail_slot_t) + THUMBNAIL_BYTES + 63) & ~63u;
+    size_t size = sizeof(tv_thumbnail_header_t) + (size_t)mSlotSize * TV_THUMBNAIL_SLOTS;
+    mSize = (size + getpagesize() - 1) & ~((size_t)getpagesize() - 1);
+
+    mFd = ashmem_create_region("tv_input_thumbnail", mSize);
+    if (mFd < 0) {
+        ALOGE("create thumbnail region fail: %s", strerror(errno));
+        return;
+    }
+
+    void *base = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (base == MAP_FAILED) {
+        ALOGE("map thumbnail region fail: %s", strerror(errno));
+        close(mFd);
+        mFd = -1;
+        return;
+    }
+    mBase = (uint8_t *)base;
+    memset(mBase, 0, mSize);
+
+    tv_thumbnail_header_t *header = (tv_thumbnail_header_t *)mBase;
+    header->magic = TV_THUMBNAIL_MAGIC;
+    header->version = TV_THUMBNAIL_VERSION;
+    header->slot_count = TV_THUMBNAIL_SLOTS;
+    header->slot_size = mSlotSize;
+    header->width = TV_THUMBNAIL_WIDTH;
+    header->height = TV_THUMBNAIL_HEIGHT;
+    header->stride = THUMBNAIL_STRIDE;
+    header->format = TV_FRAME_FORMAT_RGB565;
+    for (int i = 0; i < TV_THUMBNAIL_SLOTS; i++)
+        slotAt(i)->device_id = -1;
+
+    // clients only get a read only view of the region
+    ashmem_set_prot_region(mFd, PROT_READ);
+
+    mScratch = (uint8_t *)malloc(THUMBNAIL_BYTES);
+    if (mScratch == NULL) {
+        ALOGE("alloc thumbnail scratch fail");
+        return;
+    }
+
+    if (pthread_create(&mThread, NULL, workerThread, this) == 0) {
+        mThreadStarted = true;
+    } else {
+        ALOGE("create thumbnail worker fail: %s", strerror(errno));
+    }
+}
+
+TvThumbnailService::~TvThumbnailService()
+{
+    pthread_mutex_lock(&mMutex);
+    mExit = true;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mMutex);
+
+    if (mThreadStarted)
+        pthread_join(mThread, NULL);
+
+    if (mBase != NULL)
+        munmap(mBase, mSize);
+    if (mFd >= 0)
+        close(mFd);
+    free(mScratch);
+
+    pthread_cond_destroy(&mCond);
+    pthread_mutex_destroy(&mMutex);
+}
+
+int TvThumbnailService::getMemory(int *fd, size_t *size)
+{
+    if (fd == NULL || size == NULL)
+        return -EINVAL;
+    if (mBase == NULL)
+        return -ENOMEM;
+
+    // the caller owns the returned descriptor
+    *fd = dup(mFd);
+    if (*fd < 0)
+        return -errno;
+    *size = mSize;
+
+    // someone reads thumbnails now, start the periodic refresh
+    pthread_mutex_lock(&mMutex);
+    if (!mInUse) {
+        mInUse = true;
+        pthread_cond_signal(&mCond);
+    }
+    pthread_mutex_unlock(&mMutex);
+    return 0;
+}
+
+/*
+ * Schedules a capture of device_id.  Returns -EAGAIN when that source is not
+ * on the video layer, its slot then keeps the previous frame.
+ */
+int TvThumbnailService::refresh(int device_id)
+{
+    if (slotIndex(device_id) < 0)
+        return -EINVAL;
+    if (!mThreadStarted)
+        return -ENODEV;
+    if (mActive(mData) != device_id)
+        return -EAGAIN;
+
+    pthread_mutex_lock(&mMutex);
+    mInUse = true;
+    mRefresh = true;
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mMutex);
+    return 0;
+}
+
+// drops the cached frame of a source, e.g. when its cable is unplugged
+void TvThumbnailService::invalidate(int device_id)
+{
+    int index = slotIndex(device_id);
+    if (index < 0 || mBase == NULL)
+        return;
+
+    pthread_mutex_lock(&mMutex);
+    tv_thumbnail_slot_t *slot = slotAt(index);
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    if (seq != 0) {
+        __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        slot->device_id = -1;
+        slot->timestamp_us = 0;
+        __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
+void *TvThumbnailService::workerThread(void *arg)
+{
+    TvThumbnailService *service = (TvThumbnailService *)arg;
+    service->threadLoop();
+    return NULL;
+}
+
+void TvThumbnailService::threadLoop()
+{
+    pthread_mutex_lock(&mMutex);
+    while (!mExit) {
+        if (!mRefresh) {
+            // idle until a client maps the memory or asks for a refresh
+            if (!mInUse) {
+                pthread_cond_wait(&mCond, &mMutex);
+                continue;
+            }
+            if (mIntervalMs > 0) {
+                struct timespec ts;
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                ts.tv_sec += mIntervalMs / 1000;
+                ts.tv_nsec += (long)(mIntervalMs % 1000) * 1000000;
+                if (ts.tv_nsec >= 1000000000) {
+                    ts.tv_sec++;
+                    ts.tv_nsec -= 1000000000;
+                }
+                pthread_cond_timedwait(&mCond, &mMutex, &ts);
+            } else {
+                pthread_cond_wait(&mCond, &mMutex);
+            }
+            if (mExit)
+                break;
+        }
+        mRefresh = false;
+        pthread_mutex_unlock(&mMutex);
+
+        int device_id = mActive(mData);
+        if (slotIndex(device_id) >= 0)
+            capture(device_id);
+
+        pthread_mutex_lock(&mMutex);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
+
+void TvThumbnailService::capture(int device_id)
+{
+    tv_frame_t dst;
+    dst.format = TV_FRAME_FORMAT_RGB565;
+    dst.width = TV_THUMBNAIL_WIDTH;
+    dst.height = TV_THUMBNAIL_HEIGHT;
+    dst.plane[0] = mScratch;
+    dst.plane[1] = NULL;
+    dst.stride[0] = THUMBNAIL_STRIDE;
+    dst.stride[1] = 0;
+
+    int ret = mGrabber->grabInto(&dst);
+    if (ret != 0) {
+        ALOGV("grab thumbnail of device %d fail %d", device_id, ret);
+        return;
+    }
+
+    // the source may have been switched while grabbing, don't file it wrongly
+    if (mActive(mData) != device_id)
+        return;
+
+    pthread_mutex_lock(&mMutex);
+    tv_thumbnail_slot_t *slot = slotAt(slotIndex(device_id));
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->device_id = device_id;
+    slot->timestamp_us = ns2us(systemTime(SYSTEM_TIME_MONOTONIC));
+    memcpy((uint8_t *)(slot + 1), mScratch, THUMBNAIL_BYTES);
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&mMutex);
+
+    ALOGV("thumbnail of device %d updated, seq %u", device_id, seq + 2);
+}
+
+tv_thumbnail_slot_t *TvThumbnailService::slotAt(int index)
+{
+    return (tv_thumbnail_slot_t *)(mBase + sizeof(tv_thumbnail_header_t) + (size_t)index * mSlotSize);
+}
+
+int TvThumbnailService::slotIndex(int device_id)
+{
+    if (device_id == SOURCE_DTVKIT_PIP)
+        return SOURCE_MAX;
+    if (device_id < SOURCE_TV || device_id >= SOURCE_MAX)
+        return -1;
+    return device_id;
+}
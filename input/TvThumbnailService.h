@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 low resolution preview thumbnails of the tv inputs
+ */
+
+#ifndef _ANDROID_TV_THUMBNAIL_SERVICE_H_
+#define _ANDROID_TV_THUMBNAIL_SERVICE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "TvFrameGrabber.h"
+
+#define TV_THUMBNAIL_MAGIC      0x4d425654 /* "TVBM" */
+#define TV_THUMBNAIL_VERSION    1
+#define TV_THUMBNAIL_WIDTH      320
+#define TV_THUMBNAIL_HEIGHT     240
+/* one slot per tv_source_input_t, SOURCE_DTVKIT_PIP uses the last one */
+#define TV_THUMBNAIL_SLOTS      21
+
+#define TV_THUMBNAIL_INTERVAL_PROP    "vendor.tv.thumbnail.interval_ms"
+#define TV_THUMBNAIL_INTERVAL_DEFAULT 5000
+
+/*
+ * Shared memory layout, read only for clients:
+ *   tv_thumbnail_header_t
+ *   tv_thumbnail_slot_t[slot_count], each followed by slot_size - sizeof(slot)
+ *   bytes of RGB565 pixels.
+ * A slot is being written while its seq is odd.  Readers copy the pixels and
+ * retry if seq changed or was odd; seq == 0 means nothing was captured yet.
+ */
+typedef struct tv_thumbnail_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;        /* tv_frame_format_t */
+} tv_thumbnail_header_t;
+
+typedef struct tv_thumbnail_slot {
+    uint32_t seq;
+    int32_t device_id;
+    int64_t timestamp_us;   /* CLOCK_MONOTONIC */
+} tv_thumbnail_slot_t;
+
+/*
+ * Only the source currently routed to the video layer can be grabbed, so the
+ * worker refreshes that one at a low duty cycle and the other slots keep the
+ * last frame seen while their source was on screen.  Nothing is grabbed
+ * before the first getMemory() or refresh().
+ */
+class TvThumbnailService {
+public:
+    // returns the device id on the video layer, or -1 when nothing is playing
+    typedef int (*ActiveSourceHandler)(void *data);
+
+    TvThumbnailService(TvFrameGrabber *grabber, ActiveSourceHandler active, void *data);
+    ~TvThumbnailService();
+
+    int getMemory(int *fd, size_t *size);
+    int refresh(int device_id);
+    void invalidate(int device_id);
+
+private:
+    static void *workerThread(void *arg);
+    void threadLoop();
+    void capture(int device_id);
+    tv_thumbnail_slot_t *slotAt(int index);
+    static int slotIndex(int device_id);
+
+    TvFrameGrabber *mGrabber;
+    ActiveSourceHandler mActive;
+    void *mData;
+
+    int mFd;
+    size_t mSize;
+    uint8_t *mBase;
+    uint8_t *mScratch;
+    uint32_t mSlotSize;
+    int mIntervalMs;
+
+    pthread_mutex_t mMutex;
+    pthread_cond_t mCond;
+    pthread_t mThread;
+    bool mThreadStarted;
+    bool mExit;
+    bool mRefresh;
+    bool mInUse;            /* a client asked for thumbnails */
+};
+
+#endif/*_ANDROID_TV_THUMBNAIL_SERVICE_H_*/
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 hands out AM_FIXED_TUNNEL ids to the sideband streams
+ */
+
+#define LOG_TAG "TvTunnelAllocator"
+
+#include <errno.h>
+#include <stdio.h>
+#include <utils/Log.h>
+#include <cutils/properties.h>
+
+#include "TvTunnelAllocator.h"
+
+static const char *roleName(tv_tunnel_role_t role)
+{
+    switch (role) {
+        case TV_TUNNEL_ROLE_MAIN_VDIN:
+            return "main vdin";
+        case TV_TUNNEL_ROLE_MAIN_DTV:
+            return "main dtv";
+        case TV_TUNNEL_ROLE_PIP_DECODER:
+            return "pip decoder";
+        case TV_TUNNEL_ROLE_PIP_VDIN:
+            return "pip vdin";
+        default:
+            return "unknown";
+    }
+}
+
+TvTunnelAllocator::TvTunnelAllocator()
+{
+    pthread_mutex_init(&mMutex, NULL);
+
+    mFirst = property_get_int32(TUNNEL_FIRST_PROP, 0);
+    mCount = property_get_int32(TUNNEL_COUNT_PROP, TV_TUNNEL_ROLE_MAX);
+    if (mFirst < 0) {
+        ALOGW("%s %d out of range, use 0", TUNNEL_FIRST_PROP, mFirst);
+        mFirst = 0;
+    }
+    // a bad count must not hand out ids the platform may not have
+    if (mCount <= 0 || mCount > TV_TUNNEL_MAX) {
+        ALOGW("%s %d out of range 1..%d, use %d", TUNNEL_COUNT_PROP, mCount, TV_TUNNEL_MAX,
+                TV_TUNNEL_ROLE_MAX);
+        mCount = TV_TUNNEL_ROLE_MAX;
+    }
+
+    for (int i = 0; i < TV_TUNNEL_MAX; i++) {
+        mRefs[i] = 0;
+        mRole[i] = TV_TUNNEL_ROLE_MAX;
+    }
+    ALOGI("tunnel ids %d..%d", mFirst, mFirst + mCount - 1);
+}
+
+TvTunnelAllocator::~TvTunnelAllocator()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+bool TvTunnelAllocator::inRange(int tunnel_id)
+{
+    return tunnel_id >= mFirst && tunnel_id < mFirst + mCount;
+}
+
+int TvTunnelAllocator::acquire(tv_tunnel_role_t role)
+{
+    int tunnel_id = -EBUSY;
+
+    pthread_mutex_lock(&mMutex);
+    int preferred = mFirst + (int)role;
+    bool shared = role == TV_TUNNEL_ROLE_MAIN_VDIN || role == TV_TUNNEL_ROLE_MAIN_DTV;
+    if (shared && inRange(preferred) && mRefs[preferred - mFirst] > 0 && mRole[preferred - mFirst] == role) {
+        int refs = ++mRefs[preferred - mFirst];
+        pthread_mutex_unlock(&mMutex);
+        ALOGD("tunnel %d shared by %s, %d refs", preferred, roleName(role), refs);
+        return preferred;
+    }
+    if (inRange(preferred) && mRefs[preferred - mFirst] == 0) {
+        tunnel_id = preferred;
+    } else {
+        for (int i = 0; i < mCount; i++) {
+            if (mRefs[i] == 0) {
+                tunnel_id = mFirst + i;
+                break;
+            }
+        }
+    }
+    if (tunnel_id >= 0) {
+        mRefs[tunnel_id - mFirst] = 1;
+        mRole[tunnel_id - mFirst] = role;
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    if (tunnel_id < 0)
+        ALOGW("no tunnel left for %s", roleName(role));
+    else
+        ALOGD("tunnel %d -> %s", tunnel_id, roleName(role));
+    return tunnel_id;
+}
+
+int TvTunnelAllocator::retain(int tunnel_id)
+{
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+    if (inRange(tunnel_id) && mRefs[tunnel_id - mFirst] > 0)
+        ret = ++mRefs[tunnel_id - mFirst];
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
+
+int TvTunnelAllocator::release(int tunnel_id)
+{
+    int ret = -EINVAL;
+
+    pthread_mutex_lock(&mMutex);
+    if (inRange(tunnel_id) && mRefs[tunnel_id - mFirst] > 0) {
+        ret = --mRefs[tunnel_id - mFirst];
+        if (ret == 0) {
+            ALOGD("tunnel %d released by %s", tunnel_id, roleName(mRole[tunnel_id - mFirst]));
+            mRole[tunnel_id - mFirst] = TV_TUNNEL_ROLE_MAX;
+        }
+    }
+    pthread_mutex_unlock(&mMutex);
+
+    return ret;
+}
+
+int TvTunnelAllocator::refCount(int tunnel_id)
+{
+    int refs = 0;
+
+    pthread_mutex_lock(&mMutex);
+    if (inRange(tunnel_id))
+        refs = mRefs[tunnel_id - mFirst];
+    pthread_mutex_unlock(&mMutex);
+
+    return refs;
+}
+
+void TvTunnelAllocator::dump(int fd)
+{
+    pthread_mutex_lock(&mMutex);
+    dprintf(fd, "tunnels %d..%d:\n", mFirst, mFirst + mCount - 1);
+    for (int i = 0; i < mCount; i++) {
+        if (mRefs[i] > 0)
+            dprintf(fd, "  tunnel %d: %s, %d refs\n", mFirst + i, roleName(mRole[i]), mRefs[i]);
+    }
+    pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 hands out AM_FIXED_TUNNEL ids to the sideband streams
+ */
+
+#ifndef _ANDROID_TV_TUNNEL_ALLOCATOR_H_
+#define _ANDROID_TV_TUNNEL_ALLOCATOR_H_
+
+#include <pthread.h>
+
+#define TUNNEL_FIRST_PROP "vendor.tv.tunnel.first"
+#define TUNNEL_COUNT_PROP "vendor.tv.tunnel.count"
+
+#define TV_TUNNEL_MAX 16
+
+/*
+ * The role picks the id the video layer historically used for it, so a
+ * single main + PIP setup keeps the same tunnels as before.
+ */
+typedef enum tv_tunnel_role_e {
+    TV_TUNNEL_ROLE_MAIN_VDIN = 0,   /* tunnel 0 */
+    TV_TUNNEL_ROLE_MAIN_DTV,        /* tunnel 1 */
+    TV_TUNNEL_ROLE_PIP_DECODER,     /* tunnel 2, dtvkit PIP */
+    TV_TUNNEL_ROLE_PIP_VDIN,        /* tunnel 3, tvserver PIP */
+    TV_TUNNEL_ROLE_MAX,
+} tv_tunnel_role_t;
+
+/*
+ * acquire() returns the preferred id of the role when it is free, otherwise
+ * the lowest free id of the range.  There is a single main video layer, so
+ * the main roles share their tunnel with the previous main stream and with
+ * the sideband handle created on it; PIP roles always get an id of their
+ * own.  Each acquire() or retain() is one reference, the id is reused once
+ * the last one is released.
+ */
+class TvTunnelAllocator {
+public:
+    TvTunnelAllocator();
+    ~TvTunnelAllocator();
+
+    int acquire(tv_tunnel_role_t role);
+    int retain(int tunnel_id);
+    int release(int tunnel_id);
+    int refCount(int tunnel_id);
+    void dump(int fd);
+
+private:
+    bool inRange(int tunnel_id);
+
+    pthread_mutex_t mMutex;
+    int mFirst;
+    int mCount;
+    int mRefs[TV_TUNNEL_MAX];
+    tv_tunnel_role_t mRole[TV_TUNNEL_MAX];
+};
+
+#endif/*_ANDROID_TV_TUNNEL_ALLOCATOR_H_*/
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 tvFrameConvert throughput on capture sized frames
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "TvFrameConvert.h"
+
+namespace {
+
+struct Frame {
+    std::vector<uint8_t> plane[2];
+    tv_frame_t frame;
+
+    Frame(tv_frame_format_t format, int width, int height, int bytesPerSample, bool semiPlanar)
+    {
+        memset(&frame, 0, sizeof(frame));
+        frame.format = format;
+        frame.width = width;
+        frame.height = height;
+        frame.stride[0] = width * bytesPerSample;
+        plane[0].assign((size_t)frame.stride[0] * height, 0x80);
+        frame.plane[0] = plane[0].data();
+        if (semiPlanar) {
+            frame.stride[1] = ((width + 1) & ~1) * (format == TV_FRAME_FORMAT_P010 ? 2 : 1);
+            plane[1].assign((size_t)frame.stride[1] * ((height + 1) / 2), 0x80);
+            frame.plane[1] = plane[1].data();
+        }
+    }
+};
+
+Frame makeFrame(tv_frame_format_t format, int width, int height)
+{
+    switch (format) {
+        case TV_FRAME_FORMAT_NV21:
+        case TV_FRAME_FORMAT_NV12:
+            return Frame(format, width, height, 1, true);
+        case TV_FRAME_FORMAT_P010:
+            return Frame(format, width, height, 2, true);
+        case TV_FRAME_FORMAT_YUYV:
+        case TV_FRAME_FORMAT_RGB565:
+            return Frame(format, width, height, 2, false);
+        default:
+            return Frame(format, width, height, 4, false);
+    }
+}
+
+// args: source format, destination format, destination width and height
+void BM_Convert(benchmark::State &state)
+{
+    Frame src = makeFrame((tv_frame_format_t)state.range(0), 1920, 1080);
+    Frame dst = makeFrame((tv_frame_format_t)state.range(1), state.range(2), state.range(3));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(tvFrameConvert(&src.frame, &dst.frame));
+    state.SetItemsProcessed(state.iterations() * state.range(2) * state.range(3));
+}
+
+BENCHMARK(BM_Convert)
+    ->Args({ TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_RGBA8888, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_RGBA8888, 960, 540 })
+    ->Args({ TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_RGB565, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_NV12, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_NV21, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_YUYV, TV_FRAME_FORMAT_NV21, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_P010, TV_FRAME_FORMAT_NV12, 1920, 1080 })
+    ->Args({ TV_FRAME_FORMAT_P010, TV_FRAME_FORMAT_RGBA8888, 1280, 720 })
+    ->Unit(benchmark::kMicrosecond);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 tvFrameConvert against a per pixel scalar reference
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TvFrameConvert.h"
+
+namespace {
+
+// widths around the 16 pixel vector step, odd ones end in a half chroma pair
+const int kWidths[] = { 1, 2, 3, 7, 15, 16, 17, 31, 32, 33, 47, 64, 67 };
+const int kHeights[] = { 1, 2, 3, 5 };
+
+const tv_frame_format_t kSources[] = {
+    TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_NV12, TV_FRAME_FORMAT_YUYV, TV_FRAME_FORMAT_P010,
+};
+const tv_frame_format_t kDestinations[] = {
+    TV_FRAME_FORMAT_RGBA8888, TV_FRAME_FORMAT_RGB565, TV_FRAME_FORMAT_NV21, TV_FRAME_FORMAT_NV12,
+};
+
+int chromaRowBytes(int width)
+{
+    return (width + 1) & ~1;
+}
+
+int bytesPerSample(tv_frame_format_t format)
+{
+    switch (format) {
+        case TV_FRAME_FORMAT_YUYV:
+        case TV_FRAME_FORMAT_P010:
+        case TV_FRAME_FORMAT_RGB565:
+            return 2;
+        case TV_FRAME_FORMAT_RGBA8888:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+bool isSemiPlanar(tv_frame_format_t format)
+{
+    return format == TV_FRAME_FORMAT_NV21 || format == TV_FRAME_FORMAT_NV12
+        || format == TV_FRAME_FORMAT_P010;
+}
+
+// tightly packed planes, so a read or write past a row end shows up under ASan
+struct Image {
+    std::vector<uint8_t> plane[2];
+    tv_frame_t frame;
+
+    Image(tv_frame_format_t format, int width, int height)
+    {
+        memset(&frame, 0, sizeof(frame));
+        frame.format = format;
+        frame.width = width;
+        frame.height = height;
+
+        int rowBytes = width * bytesPerSample(format);
+        plane[0].resize((size_t)rowBytes * height);
+        frame.plane[0] = plane[0].data();
+        frame.stride[0] = rowBytes;
+        if (isSemiPlanar(format)) {
+            int uvBytes = chromaRowBytes(width) * bytesPerSample(format);
+            plane[1].resize((size_t)uvBytes * ((height + 1) / 2));
+            frame.plane[1] = plane[1].data();
+            frame.stride[1] = uvBytes;
+        }
+    }
+
+    void fill(unsigned seed)
+    {
+        srand(seed);
+        for (int i = 0; i < 2; i++) {
+            for (size_t j = 0; j < plane[i].size(); j++)
+                plane[i][j] = (uint8_t)rand();
+        }
+    }
+};
+
+uint8_t clampU8(int v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+struct Yuv {
+    int y, u, v;
+};
+
+// the 8 bit sample the converter works on at source column x, row y
+Yuv sourceAt(const tv_frame_t &src, int x, int y, int chromaX)
+{
+    Yuv s;
+    const uint8_t *row = src.plane[0] + (size_t)y * src.stride[0];
+    const uint8_t *uv = src.plane[1] ? src.plane[1] + (size_t)(y / 2) * src.stride[1] : NULL;
+
+    switch (src.format) {
+        case TV_FRAME_FORMAT_NV21:
+        case TV_FRAME_FORMAT_NV12: {
+            bool vFirst = src.format == TV_FRAME_FORMAT_NV21;
+            s.y = row[x];
+            s.u = uv[chromaX + (vFirst ? 1 : 0)];
+            s.v = uv[chromaX + (vFirst ? 0 : 1)];
+            break;
+        }
+        case TV_FRAME_FORMAT_YUYV:
+            s.y = row[x * 2];
+            s.u = row[chromaX * 2 + 1];
+            s.v = chromaX + 1 < src.width ? row[chromaX * 2 + 3] : 128;
+            break;
+        case TV_FRAME_FORMAT_P010: {
+            const uint16_t *y16 = (const uint16_t *)row;
+            const uint16_t *uv16 = (const uint16_t *)uv;
+            s.y = y16[x] >> 8;
+            s.u = uv16[chromaX] >> 8;
+            s.v = uv16[chromaX + 1] >> 8;
+            break;
+        }
+        default:
+            abort();
+    }
+    return s;
+}
+
+// same nearest neighbour mapping as the converter
+int mapCoord(int d, int srcSize, int dstSize)
+{
+    if (srcSize == dstSize)
+        return d;
+    return (int)(((int64_t)(2 * d + 1) * srcSize) / (2 * dstSize));
+}
+
+void referenceConvert(const tv_frame_t &src, tv_frame_t *dst)
+{
+    for (int y = 0; y < dst->height; y++) {
+        int sy = mapCoord(y, src.height, dst->height);
+        for (int x = 0; x < dst->width; x++) {
+            int sx = mapCoord(x, src.width, dst->width);
+            // chroma pairs follow the even destination column of the pair
+            int chromaX = mapCoord(x & ~1, src.width, dst->width) & ~1;
+            Yuv s = sourceAt(src, sx, sy, chromaX);
+            uint8_t *out = dst->plane[0] + (size_t)y * dst->stride[0];
+
+            if (dst->format == TV_FRAME_FORMAT_NV21 || dst->format == TV_FRAME_FORMAT_NV12) {
+                out[x] = s.y;
+                if ((y & 1) == 0 && (x & 1) == 0) {
+                    uint8_t *uv = dst->plane[1] + (size_t)(y / 2) * dst->stride[1];
+                    bool vFirst = dst->format == TV_FRAME_FORMAT_NV21;
+                    uv[x] = vFirst ? s.v : s.u;
+                    uv[x + 1] = vFirst ? s.u : s.v;
+                }
+                continue;
+            }
+
+            int yy = 298 * (s.y - 16) + 128;
+            int u = s.u - 128;
+            int v = s.v - 128;
+            uint8_t r = clampU8((yy + 409 * v) >> 8);
+            uint8_t g = clampU8((yy - 100 * u - 208 * v) >> 8);
+            uint8_t b = clampU8((yy + 516 * u) >> 8);
+            if (dst->format == TV_FRAME_FORMAT_RGBA8888) {
+                out[x * 4] = r;
+                out[x * 4 + 1] = g;
+                out[x * 4 + 2] = b;
+                out[x * 4 + 3] = 255;
+            } else {
+                ((uint16_t *)out)[x] = (uint16_t)(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+            }
+        }
+    }
+}
+
+void expectSameImage(const Image &actual, const Image &expected, const char *what)
+{
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(actual.plane[i].size(), expected.plane[i].size());
+        for (size_t j = 0; j < actual.plane[i].size(); j++) {
+            ASSERT_EQ(expected.plane[i][j], actual.plane[i][j])
+                    << what << ": plane " << i << " byte " << j;
+        }
+    }
+}
+
+void checkConversion(tv_frame_format_t srcFormat, int sw, int sh,
+        tv_frame_format_t dstFormat, int dw, int dh)
+{
+    char what[128];
+    snprintf(what, sizeof(what), "%d %dx%d -> %d %dx%d", srcFormat, sw, sh, dstFormat, dw, dh);
+
+    Image src(srcFormat, sw, sh);
+    src.fill(sw * 131 + sh * 7 + srcFormat);
+    Image actual(dstFormat, dw, dh);
+    Image expected(dstFormat, dw, dh);
+
+    ASSERT_EQ(0, tvFrameConvert(&src.frame, &actual.frame)) << what;
+    referenceConvert(src.frame, &expected.frame);
+    expectSameImage(actual, expected, what);
+}
+
+TEST(TvFrameConvertTest, SameSizeMatchesReference)
+{
+    for (tv_frame_format_t srcFormat : kSources) {
+        for (tv_frame_format_t dstFormat : kDestinations) {
+            for (int w : kWidths) {
+                for (int h : kHeights)
+                    checkConversion(srcFormat, w, h, dstFormat, w, h);
+            }
+        }
+    }
+}
+
+TEST(TvFrameConvertTest, ScaledMatchesReference)
+{
+    static const struct {
+        int sw, sh, dw, dh;
+    } kSizes[] = {
+        { 67, 5, 33, 3 },
+        { 64, 4, 17, 2 },
+        { 17, 3, 64, 6 },
+        { 33, 2, 48, 5 },
+        { 48, 5, 31, 1 },
+    };
+
+    for (tv_frame_format_t srcFormat : kSources) {
+        for (tv_frame_format_t dstFormat : kDestinations) {
+            for (const auto &size : kSizes)
+                checkConversion(srcFormat, size.sw, size.sh, dstFormat, size.dw, size.dh);
+        }
+    }
+}
+
+TEST(TvFrameConvertTest, RejectsUnsupportedPairs)
+{
+    Image src(TV_FRAME_FORMAT_NV21, 16, 2);
+    Image yuyv(TV_FRAME_FORMAT_YUYV, 16, 2);
+    Image rgba(TV_FRAME_FORMAT_RGBA8888, 16, 2);
+
+    EXPECT_EQ(-EINVAL, tvFrameConvert(&src.frame, &yuyv.frame));
+    EXPECT_EQ(-EINVAL, tvFrameConvert(&rgba.frame, &src.frame));
+    src.frame.width = 0;
+    EXPECT_EQ(-EINVAL, tvFrameConvert(&src.frame, &rgba.frame));
+}
+
+}
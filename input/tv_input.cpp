@@ -17,14 +17,16 @@
 #define LOG_TAG "tv_input"
 #include <fcntl.h>
 #include <errno.h>
+#include <stdio.h>
 
 #include <cutils/native_handle.h>
 
 #include <hardware/tv_input.h>
 #include "tv_input.h"
 #include <tvcmd.h>
+#include <TvTrace.h>
 #include <cutils/log.h>
-//#include <ui/GraphicBufferMapper.h>
+#include <ui/GraphicBufferMapper.h>
 //#include <ui/GraphicBuffer.h>
 #include <amlogic/am_gralloc_ext.h>
 #include <hardware/hardware.h>
@@ -36,20 +38,20 @@
 //static const int SCREENSOURCE_GRALLOC_USAGE = (
 //    GRALLOC_USAGE_HW_TEXTURE | GRALLOC_USAGE_HW_RENDER |
 //    GRALLOC_USAGE_SW_READ_RARELY | GRALLOC_USAGE_SW_WRITE_NEVER);
+static const uint32_t CAPTURE_GRALLOC_USAGE = GRALLOC_USAGE_SW_WRITE_OFTEN;
+
+// frame size grabbed from the video layer, matches the STREAM_ID_FRAME_CAPTURE config
+#define CAPTURE_SOURCE_WIDTH  1920
+#define CAPTURE_SOURCE_HEIGHT 1080
 
-static int capWidth;
-static int capHeight;
-static int supportDevices[20];
-static int count = 0;
 
-native_handle_t *pFixedTvStream = nullptr;
-native_handle_t *pTvStream = nullptr;
-native_handle_t *pMainTvStream = nullptr;
-native_handle_t *pPipTvStream = nullptr;
-native_handle_t *pUnavailableTvStream = nullptr;
 
 void EventCallback::onTvEvent (const source_connect_t &scrConnect) {
     tv_input_private_t *priv = (tv_input_private_t *)(mPri);
+    TV_TRACE_CALL();
+
+    if (!priv->hotplugDetect)
+        return;
 
     ALOGI("callback::onTvEvent msgType = %d", scrConnect.msgType);
     switch (scrConnect.msgType) {
@@ -57,7 +59,7 @@ void EventCallback::onTvEvent (const source_connect_t &scrConnect) {
             tv_source_input_t source = (tv_source_input_t)scrConnect.source;
             int connectState = scrConnect.state;
             ALOGI("callback::onTvEvent source = %d, status = %d", source, connectState);
-            if (SOURCE_AV1 <= source && source <= SOURCE_HDMI4) {
+            if (tvSourceTraits(source).hotplug) {
                 notifyDeviceStatus(priv, source, TV_INPUT_EVENT_STREAM_CONFIGURATIONS_CHANGED);
             }
         }
@@ -66,7 +68,7 @@ void EventCallback::onTvEvent (const source_connect_t &scrConnect) {
         case CHECK_SOURCE_VALID: {
             bool source_status = priv->mpTv->getSourceStatus();
             tv_source_input_t hold_source = priv->mpTv->checkHoldSource();
-            if (!source_status && (SOURCE_DTVKIT == hold_source || SOURCE_DTVKIT_PIP == hold_source)) {
+            if (!source_status && tvSourceTraits(hold_source).dtvkit) {
                 priv->mpTv->stopTv(hold_source);
             }
         }
@@ -77,6 +79,36 @@ void EventCallback::onTvEvent (const source_connect_t &scrConnect) {
     }
 }
 
+/*
+ * CLOSE_CAPTION_CALLBACK body: bodyInt[0] is the data length, followed by
+ * one cc byte per int.
+ */
+void EventCallback::onTvMessage (const tv_parcel_t &parcel) {
+    tv_input_private_t *priv = (tv_input_private_t *)(mPri);
+
+    pthread_mutex_lock(&priv->messageLock);
+    tv_input_message_cb_t callback = priv->messageCallback;
+    void *data = priv->message_data;
+    pthread_mutex_unlock(&priv->messageLock);
+
+    if (!callback || parcel.bodyInt.empty())
+        return;
+
+    int device_id = priv->mpTv->getDeviceGivenId();
+    int stream_id = priv->mpTv->getStreamGivenId();
+    if (device_id < 0 || stream_id < 0)
+        return;
+
+    size_t size = parcel.bodyInt[0];
+    if (size == 0 || size > parcel.bodyInt.size() - 1) {
+        ALOGW("callback::onTvMessage bad cc length %zu/%zu", size, parcel.bodyInt.size());
+        return;
+    }
+
+    callback(data, device_id, stream_id, TV_INPUT_MESSAGE_CLOSED_CAPTION,
+            parcel.bodyInt.data() + 1, size);
+}
+
 static int channelCheckStatus(tv_input_private_t *priv, int check_status, int device_id)
 {
     int ret = 0;
@@ -87,33 +119,43 @@ static int channelCheckStatus(tv_input_private_t *priv, int check_status, int de
     return ret;
 }
 
-void channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int stream_id) {
+/*
+ * Returns non zero only when a PIP view could not start, the other paths
+ * report their failures through the source status as before.
+ */
+int channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int stream_id) {
+    TV_TRACE_CALL();
     if (priv->mpTv) {
         ALOGI ("%s, device id:%d, %s.\n", __FUNCTION__, device_id, opsStart ? "startTV": "stopTV");
 
-        if ((SOURCE_DTVKIT == device_id || SOURCE_DTVKIT_PIP == device_id) && !(priv->mpTv->isTvPlatform())) {
+        const tv_source_traits_t &traits = tvSourceTraits(device_id);
+        if (traits.dtvkit && !(priv->mpTv->isTvPlatform())) {
             priv->mpTv->setDeviceGivenId(opsStart ? device_id : -1);
-            return;
+            return 0;
         }
 
         if (opsStart) {
             tv_source_input_t hold_source = priv->mpTv->checkHoldSource();
-            if (SOURCE_DTVKIT == hold_source || SOURCE_DTVKIT_PIP == hold_source) {
-                if (SOURCE_DTVKIT == (tv_source_input_t) device_id ||
-                    SOURCE_DTVKIT_PIP == (tv_source_input_t) device_id) {
+            if (tvSourceTraits(hold_source).dtvkit) {
+                if (traits.dtvkit) {
                     priv->mpTv->switchSourceInput((tv_source_input_t) device_id);
                     priv->mpTv->setDeviceGivenId(device_id);
                     priv->mpTv->setStreamGivenId(stream_id);
                     priv->mpTv->setSourceStatus(true);
 
-                    return;
+                    return 0;
                 } else {
                     priv->mpTv->stopTv(hold_source);
                 }
             }
-            if (stream_id  == STREAM_ID_PIP && device_id < SOURCE_VGA) {
-                priv->mpTv->StartTvInPIP((tv_source_input_t) device_id);
-                priv->mpTv->setPipDeviceGivenId(device_id);
+            if (stream_id  == STREAM_ID_PIP && traits.pip_capable) {
+                // every pip view starts and stops the source under its own view id
+                tv_view_t view;
+                if (!priv->multiView->getView(device_id, stream_id, &view))
+                    return -EINVAL;
+                int ret = priv->mpTv->StartTvInPIP((tv_source_input_t) device_id, view.view_id);
+                if (ret < 0)
+                    return ret;
                 priv->mpTv->setPipStreamGivenId(stream_id);
             } else {
                 priv->mpTv->startTv((tv_source_input_t) device_id);
@@ -126,11 +168,11 @@ void channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int
             /* Force the current source to stop when the current source blocks the start of other sources,
              * and the close action of the blocked source is also triggered.
              */
-            if (stream_id  == STREAM_ID_PIP && (device_id < SOURCE_VGA)) {
-                priv->mpTv->StopTvInPIP();
-                priv->mpTv->setPipDeviceGivenId(-1);
-                priv->mpTv->setPipStreamGivenId(-1);
-                return;
+            if (stream_id  == STREAM_ID_PIP && traits.pip_capable) {
+                tv_view_t view;
+                if (priv->multiView->getView(device_id, stream_id, &view))
+                    priv->mpTv->StopTvInPIP(view.view_id);
+                return 0;
             }
 
             tv_source_input_t wait_source = priv->mpTv->checkWaitSource(true);
@@ -141,18 +183,16 @@ void channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int
                     priv->mpTv->setStreamGivenId(-1);
                 }
 
-                return;
+                return 0;
             }
 
             /* DTVKit is actually stopped only when a new source is entered */
-            if (wait_source == SOURCE_INVALID &&
-                (SOURCE_DTVKIT == (tv_source_input_t) device_id ||
-                SOURCE_DTVKIT_PIP == (tv_source_input_t) device_id)) {
+            if (wait_source == SOURCE_INVALID && traits.dtvkit) {
                 priv->mpTv->setDeviceGivenId(-1);
                 priv->mpTv->setStreamGivenId(-1);
                 priv->mpTv->setSourceStatus(false);
 
-                return;
+                return 0;
             }
 
             char buf[PROPERTY_VALUE_MAX] = { 0 };
@@ -171,6 +211,7 @@ void channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int
             }
         }
     }
+    return 0;
 }
 
 int notifyDeviceStatus(tv_input_private_t *priv, tv_source_input_t inputSrc, int type)
@@ -178,55 +219,23 @@ int notifyDeviceStatus(tv_input_private_t *priv, tv_source_input_t inputSrc, int
     tv_input_event_t event;
     const char address[64] = {0};
     event.device_info.device_id = inputSrc;
-    event.device_info.audio_type = AUDIO_DEVICE_NONE;
+    const tv_source_traits_t &traits = tvSourceTraits(inputSrc);
+    event.device_info.type = traits.type;
+    event.device_info.audio_type = traits.audio_type;
     event.device_info.audio_address = address;
+    event.device_info.hdmi.port_id = traits.hdmi_port;
     event.type = type;
-    switch (inputSrc) {
-        case SOURCE_TV:
-        case SOURCE_DTV:
-        case SOURCE_ADTV:
-        case SOURCE_DTVKIT:
-        case SOURCE_DTVKIT_PIP:
-            event.device_info.type = TV_INPUT_TYPE_TUNER;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_TV_TUNER;
-            break;
-        case SOURCE_AV1:
-        case SOURCE_AV2:
-            event.device_info.type = TV_INPUT_TYPE_COMPOSITE;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_LINE;
-            break;
-        case SOURCE_HDMI1:
-        case SOURCE_HDMI2:
-        case SOURCE_HDMI3:
-        case SOURCE_HDMI4:
-            event.device_info.type = TV_INPUT_TYPE_HDMI;
-            event.device_info.hdmi.port_id = inputSrc - SOURCE_YPBPR2;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_HDMI;
-            break;
-        case SOURCE_SPDIF:
-            event.device_info.type = TV_INPUT_TYPE_OTHER_HARDWARE;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_SPDIF;
-            break;
-        case SOURCE_AUX:
-            event.device_info.type = TV_INPUT_TYPE_OTHER_HARDWARE;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_LINE;
-            break;
-        case SOURCE_ARC:
-            event.device_info.type = TV_INPUT_TYPE_OTHER_HARDWARE;
-            event.device_info.audio_type = AUDIO_DEVICE_IN_HDMI_ARC;
-            break;
-        default:
-            break;
-    }
+    if (type == TV_INPUT_EVENT_DEVICE_UNAVAILABLE && priv->thumbnailService)
+        priv->thumbnailService->invalidate(inputSrc);
     priv->callback->notify(&priv->device, &event, priv->callback_data);
     return 0;
 }
 
 
-static bool checkDeviceID(int device_id) {
-    for (int i = 0; i< count; i++) {
-        if (device_id == supportDevices[i]) {
-           ALOGD("checkDeviceID supportDevices[%d] = %d\n", i, supportDevices[i]);
+static bool checkDeviceID(tv_input_private_t *priv, int device_id) {
+    for (int i = 0; i< priv->supportDeviceCount; i++) {
+        if (device_id == priv->supportDevices[i]) {
+           ALOGD("checkDeviceID supportDevices[%d] = %d\n", i, priv->supportDevices[i]);
            return true;
         }
     }
@@ -263,64 +272,79 @@ static int notifyCaptureFail(tv_input_private_t *priv, int device_id, int stream
     return 0;
 }
 
-static bool getAvailableStreamConfigs(int dev_id __unused, int *num_configurations, const tv_stream_config_t **configs)
+/* read only, so every device instance can hand out pointers into them */
+static const tv_stream_config_t kDtvStreamConfigs[] = {
+    {STREAM_ID_NORMAL, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 1920, 1080, {}},
+    {STREAM_ID_MAIN, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 1920, 1080, {}},
+};
+
+static const tv_stream_config_t kDtvkitPipStreamConfigs[] = {
+    {STREAM_ID_PIP, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 320, 240, {}},
+    {STREAM_ID_FRAME_CAPTURE, TV_STREAM_TYPE_BUFFER_PRODUCER, 1920, 1080, {}},
+};
+
+static const tv_stream_config_t kDefaultStreamConfigs[] = {
+    {STREAM_ID_PIP, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 1920, 1080, {}},
+    {STREAM_ID_MAIN, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 1920, 1080, {}},
+};
+
+static const tv_stream_config_t kUnavailableStreamConfigs[] = {
+    {STREAM_ID_UNAVAILABLE, TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE, 1920, 1080, {}},
+};
+
+static bool getAvailableStreamConfigs(int dev_id, int *num_configurations, const tv_stream_config_t **configs)
 {
-    static tv_stream_config_t mconfig[2];
     switch (tv_source_input_t(dev_id)) {
         case SOURCE_ADTV:
         case SOURCE_DTVKIT:
-            mconfig[0].stream_id = STREAM_ID_NORMAL;
-            mconfig[0].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE ;
-            mconfig[0].max_video_width = 1920;
-            mconfig[0].max_video_height = 1080;
-            mconfig[1].stream_id = STREAM_ID_MAIN;
-            mconfig[1].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE ;
-            mconfig[1].max_video_width = 1920;
-            mconfig[1].max_video_height = 1080;
+            *configs = kDtvStreamConfigs;
             break;
         case SOURCE_DTVKIT_PIP:
-            mconfig[0].stream_id = STREAM_ID_PIP;
-            mconfig[0].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE ;
-            mconfig[0].max_video_width = 320;
-            mconfig[0].max_video_height = 240;
-            mconfig[1].stream_id = STREAM_ID_FRAME_CAPTURE;
-            mconfig[1].type = TV_STREAM_TYPE_BUFFER_PRODUCER ;
-            mconfig[1].max_video_width = 1920;
-            mconfig[1].max_video_height = 1080;
+            *configs = kDtvkitPipStreamConfigs;
             break;
         default:
-            mconfig[0].stream_id = STREAM_ID_PIP;
-            mconfig[0].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE ;
-            mconfig[0].max_video_width = 1920;
-            mconfig[0].max_video_height = 1080;
-            mconfig[1].stream_id = STREAM_ID_MAIN;
-            mconfig[1].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE ;
-            mconfig[1].max_video_width = 1920;
-            mconfig[1].max_video_height = 1080;
+            *configs = kDefaultStreamConfigs;
             break;
     }
     *num_configurations = 2;
-    *configs = mconfig;
     return true;
 }
 
 static int getUnavailableStreamConfigs(int dev_id __unused, int *num_configurations, const tv_stream_config_t **configs)
 {
-    static tv_stream_config_t mConfig[1];
-    mConfig[0].stream_id = STREAM_ID_UNAVAILABLE;
-    mConfig[0].type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-    mConfig[0].max_video_width = 1920;
-    mConfig[0].max_video_height = 1080;
     *num_configurations = 1;
-    *configs = mConfig;
+    *configs = kUnavailableStreamConfigs;
     return 0;
 }
 
+/*
+ * Tunnel of the view, acquired for its role on first use.  The view holds
+ * the reference and releases it when the stream is closed.
+ */
+static int viewTunnel(tv_input_private_t *priv, int device_id, int stream_id, tv_tunnel_role_t role)
+{
+    tv_view_t view;
+
+    if (priv->multiView->getView(device_id, stream_id, &view) && view.tunnel_id >= 0)
+        return view.tunnel_id;
+
+    int tunnelId = priv->tunnels->acquire(role);
+    if (tunnelId < 0)
+        return tunnelId;
+    if (priv->multiView->setTunnel(device_id, stream_id, tunnelId) != 0) {
+        priv->tunnels->release(tunnelId);
+        return -EBUSY;
+    }
+    return tunnelId;
+}
+
 static int getTvStream(tv_input_private_t *priv, tv_stream_t *stream, int input_id)
 {
+    TV_TRACE_CALL();
     int fixed_tunnel = -1;
     char value[PROPERTY_VALUE_MAX] = { 0 };
     int tunnelId = -1;
+    native_handle_t *handle = nullptr;
 
     if (property_get("vendor.tv.fixed_tunnel", value, NULL) > 0) {
         fixed_tunnel = atoi(value);
@@ -328,92 +352,45 @@ static int getTvStream(tv_input_private_t *priv, tv_stream_t *stream, int input_
     ALOGD("fixed_tunnel =%d", fixed_tunnel);
     ALOGD("getTvStream stream_id = %d", stream->stream_id);
     if (!fixed_tunnel) {
-        if (pFixedTvStream == nullptr) {
-            pFixedTvStream = am_gralloc_create_sideband_handle(AM_TV_SIDEBAND, 1);
-        }
-        if (pFixedTvStream == nullptr) {
-            ALOGE("tvstream can not be initialized");
-            return -EINVAL;
-        }
-        stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-        stream->sideband_stream_source_handle = pFixedTvStream;
+        handle = priv->streams->acquire(input_id, stream->stream_id, TV_STREAM_SLOT_FIXED, AM_TV_SIDEBAND, -1);
     } else {
-        if (stream->stream_id == STREAM_ID_NORMAL) {
-            if (pTvStream == nullptr) {
-                if ((SOURCE_DTVKIT == input_id) || (SOURCE_ADTV == input_id)) {
-                    if (priv->mpTv->isMultiDemux() || fixed_tunnel == 1) {
-                        pTvStream = am_gralloc_create_sideband_handle(AM_FIXED_TUNNEL, 1);
-                        tunnelId = 1;
-                    } else {
-                        pTvStream = am_gralloc_create_sideband_handle(AM_TV_SIDEBAND, 1);
-                    }
-                } else {
-                    if (priv->mpTv->isMultiDemux()|| fixed_tunnel == 1) {
-                        pTvStream = am_gralloc_create_sideband_handle(AM_FIXED_TUNNEL, 0);
-                        tunnelId = 0;
-                    }
-                    else
-                        pTvStream = am_gralloc_create_sideband_handle(AM_TV_SIDEBAND, 1);
+        bool tunneled = priv->mpTv->isMultiDemux() || fixed_tunnel == 1;
+        if (stream->stream_id == STREAM_ID_NORMAL || stream->stream_id == STREAM_ID_MAIN) {
+            //the MAIN window of the pip function stays on the vdin tunnel
+            tv_tunnel_role_t role = TV_TUNNEL_ROLE_MAIN_VDIN;
+            if (stream->stream_id == STREAM_ID_NORMAL && tvSourceTraits(input_id).demux)
+                role = TV_TUNNEL_ROLE_MAIN_DTV;
+            if (tunneled) {
+                tunnelId = viewTunnel(priv, input_id, stream->stream_id, role);
+                if (tunnelId < 0) {
+                    ALOGE("no tunnel for stream_id=%d", stream->stream_id);
+                    return -EBUSY;
                 }
-                if (pTvStream == nullptr) {
-                    ALOGE("tvstream can not be initialized");
-                    return -EINVAL;
-                }
-            } else if (priv->mpTv->isMultiDemux()  || fixed_tunnel == 1) {
-                if ((SOURCE_DTVKIT == input_id) || (SOURCE_ADTV == input_id)) {
-                    tunnelId = 1;
-                } else {
-                    tunnelId = 0;
-                }
-                ALOGD("STREAM_ID_NORMAL set tunnel id = %d", tunnelId);
+                ALOGD("stream_id=%d set tunnel id = %d", stream->stream_id, tunnelId);
             }
-            stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-            stream->sideband_stream_source_handle = pTvStream;
-        } else if (stream->stream_id == STREAM_ID_MAIN) {
-            //add such for pip function
-            if (pMainTvStream == nullptr) {
-                ALOGD("getTvStream stream_id=%d tunnelId=%d", stream->stream_id, 1);
-                if (priv->mpTv->isMultiDemux() || fixed_tunnel == 1) {
-                    pMainTvStream = am_gralloc_create_sideband_handle(AM_FIXED_TUNNEL, 0);
-                    tunnelId = 0;
-                } else {
-                    pMainTvStream = am_gralloc_create_sideband_handle(AM_TV_SIDEBAND, 1);
-                }
-                if (pMainTvStream == nullptr) {
-                    ALOGE("tvstream can not be initialized");
-                    return -EINVAL;
-                }
-            } else if (priv->mpTv->isMultiDemux() || fixed_tunnel == 1) {
-                tunnelId = 0;
-                ALOGD("STREAM_ID_MAIN set tunnel id = %d", tunnelId);
-            }
-            stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-            stream->sideband_stream_source_handle = pMainTvStream;
+            handle = priv->streams->acquire(input_id, stream->stream_id,
+                    stream->stream_id == STREAM_ID_NORMAL ? TV_STREAM_SLOT_NORMAL : TV_STREAM_SLOT_MAIN,
+                    tunneled ? AM_FIXED_TUNNEL : AM_TV_SIDEBAND, tunnelId);
         } else if (stream->stream_id == STREAM_ID_PIP) {
-            //add such for pip function
-            if (pPipTvStream == nullptr) {
-                if ( input_id < SOURCE_VGA && priv->mpTv->IsHdmiPIP(input_id)) {
-                    ALOGE("getTvStream Tvserver PIP stream_id=%d tunnelId=%d", stream->stream_id, 3);
-                    pPipTvStream = am_gralloc_create_sideband_handle(AM_FIXED_TUNNEL, 3);
-                } else {
-                    ALOGD("getTvStream DTVKIT PIP stream_id=%d tunnelId=%d", stream->stream_id, 2);
-                    pPipTvStream = am_gralloc_create_sideband_handle(AM_FIXED_TUNNEL, 2);
-                }
-            if (pPipTvStream == nullptr) {
-                    ALOGE("pip tvstream can not be initialized");
-                    return -EINVAL;
-                }
+            tv_view_t view;
+            if (!priv->multiView->getView(input_id, stream->stream_id, &view)) {
+                ALOGE("pip view of device %d is not admitted", input_id);
+                return -EINVAL;
             }
-            stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-            stream->sideband_stream_source_handle = pPipTvStream;
-        } else if (stream->stream_id == STREAM_ID_FRAME_CAPTURE) {
-            stream->type = TV_STREAM_TYPE_BUFFER_PRODUCER;
+            ALOGD("getTvStream PIP stream_id=%d tunnelId=%d", stream->stream_id, view.tunnel_id);
+            handle = priv->streams->acquire(input_id, stream->stream_id, TV_STREAM_SLOT_PRIVATE,
+                    AM_FIXED_TUNNEL, view.tunnel_id);
         } else if (stream->stream_id == STREAM_ID_UNAVAILABLE) {
-            pUnavailableTvStream = am_gralloc_create_sideband_handle(AM_TV_SIDEBAND, 1);
-            stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
-            stream->sideband_stream_source_handle = pUnavailableTvStream;
+            handle = priv->streams->acquire(input_id, stream->stream_id, TV_STREAM_SLOT_PRIVATE, AM_TV_SIDEBAND, -1);
         }
     }
+    if (handle == nullptr) {
+        ALOGE("tvstream can not be initialized");
+        return -EINVAL;
+    }
+    stream->type = TV_STREAM_TYPE_INDEPENDENT_VIDEO_SOURCE;
+    stream->sideband_stream_source_handle = handle;
+
     ALOGD("new stream tunnel id: %d",tunnelId);
     if (tunnelId != -1) {
         priv->mpTv->setStreamTunnelId(tunnelId);
@@ -424,20 +401,20 @@ static int getTvStream(tv_input_private_t *priv, tv_stream_t *stream, int input_
 void initTvDevices(tv_input_private_t *priv)
 {
     priv->mpTv->init();
-    priv->mpTv->getSupportInputDevices(supportDevices, &count);
+    priv->mpTv->getSupportInputDevices(priv->supportDevices, &priv->supportDeviceCount);
 
-    if (count == 0) {
+    if (priv->supportDeviceCount == 0) {
         ALOGE("tv.source.input.ids.default is not set.");
         return;
     }
 
-    bool isHotplugDetectOn = priv->mpTv->getHdmiAvHotplugDetectOnoff();
-    ALOGI("hdmi/av hotplug detect on: %s", isHotplugDetectOn?"YES":"NO");
-    if (isHotplugDetectOn)
-        priv->mpTv->setTvObserver(priv->eventCallback);
+    priv->hotplugDetect = priv->mpTv->getHdmiAvHotplugDetectOnoff();
+    ALOGI("hdmi/av hotplug detect on: %s", priv->hotplugDetect?"YES":"NO");
+    // always registered, TvMessages come through it whatever the hotplug setting
+    priv->mpTv->setTvObserver(priv->eventCallback);
 
-    for (int i = 0; i < count; i++) {
-        tv_source_input_t inputSrc = (tv_source_input_t)supportDevices[i];
+    for (int i = 0; i < priv->supportDeviceCount; i++) {
+        tv_source_input_t inputSrc = (tv_source_input_t)priv->supportDevices[i];
         notifyDeviceStatus(priv, inputSrc, TV_INPUT_EVENT_DEVICE_AVAILABLE);
     }
 }
@@ -463,13 +440,13 @@ static int tv_input_initialize(struct tv_input_device *dev,
     return 0;
 }
 
-static int tv_input_get_stream_configurations(const struct tv_input_device *dev __unused,
+static int tv_input_get_stream_configurations(const struct tv_input_device *dev,
         int device_id, int *num_configurations,
         const tv_stream_config_t **configs)
 {
     tv_input_private_t *priv = (tv_input_private_t *)dev;
 
-    if (!checkDeviceID(device_id))
+    if (!priv || !checkDeviceID(priv, device_id))
         return -EINVAL;
 
     int isHotplugDetectOn = priv->mpTv->getHdmiAvHotplugDetectOnoff();
@@ -479,7 +456,7 @@ static int tv_input_get_stream_configurations(const struct tv_input_device *dev
     } else {
         LOGD("%s:Hot plug enabled!\n", __FUNCTION__);
         bool status = true;
-        if (SOURCE_AV1 <= device_id && device_id <= SOURCE_HDMI4) {
+        if (tvSourceTraits(device_id).hotplug) {
             status = priv->mpTv->getSourceConnectStatus((tv_source_input_t)device_id);
         }
         LOGD("tv_input_get_stream_configurations  source = %d, status = %d", device_id, status);
@@ -494,10 +471,59 @@ static int tv_input_get_stream_configurations(const struct tv_input_device *dev
 }
 
 
+static int viewSize(int device_id, int stream_id, int *width, int *height)
+{
+    int num = 0;
+    const tv_stream_config_t *configs = nullptr;
+
+    getAvailableStreamConfigs(device_id, &num, &configs);
+    for (int i = 0; i < num; i++) {
+        if (configs[i].stream_id == stream_id) {
+            *width = configs[i].max_video_width;
+            *height = configs[i].max_video_height;
+            return 0;
+        }
+    }
+    return -EINVAL;
+}
+
+/*
+ * Reserves a view for the video streams.  PIP views get their tunnel here,
+ * the main window acquires one in getTvStream once the handle type is known.
+ */
+static int admitView(tv_input_private_t *priv, int device_id, int stream_id)
+{
+    int width = 0, height = 0;
+    int tunnelId = -1;
+
+    if (stream_id != STREAM_ID_NORMAL && stream_id != STREAM_ID_MAIN && stream_id != STREAM_ID_PIP)
+        return 0;
+
+    if (viewSize(device_id, stream_id, &width, &height) != 0) {
+        width = CAPTURE_SOURCE_WIDTH;
+        height = CAPTURE_SOURCE_HEIGHT;
+    }
+    if (stream_id == STREAM_ID_PIP) {
+        bool vdinPip = tvSourceTraits(device_id).pip_capable && priv->mpTv->IsHdmiPIP(device_id);
+        tunnelId = priv->tunnels->acquire(vdinPip ? TV_TUNNEL_ROLE_PIP_VDIN : TV_TUNNEL_ROLE_PIP_DECODER);
+        if (tunnelId < 0)
+            return -EBUSY;
+    }
+
+    if (priv->multiView->admit(device_id, stream_id, width, height, tunnelId, NULL) != TV_VIEW_ADMIT) {
+        ALOGW("no room for stream %d of device %d", stream_id, device_id);
+        if (tunnelId >= 0)
+            priv->tunnels->release(tunnelId);
+        return -EBUSY;
+    }
+    return 0;
+}
+
 static int tv_input_open_stream(struct tv_input_device *dev, int device_id,
                                 tv_stream_t *stream)
 {
     tv_input_private_t *priv = (tv_input_private_t *)dev;
+    TV_TRACE_CALL();
 
     if (!priv || !stream)
         return -EINVAL;
@@ -505,69 +531,68 @@ static int tv_input_open_stream(struct tv_input_device *dev, int device_id,
     ALOGD("open_stream: device_id = %d, streamid = %d, mStreamGivenId = %d, mDeviceGivenId = %d\n",
             device_id, stream->stream_id, priv->mpTv->getStreamGivenId(), priv->mpTv->getDeviceGivenId());
 
-    if (!checkDeviceID(device_id) || !checkStreamID(stream->stream_id))
+    if (!checkDeviceID(priv, device_id) || !checkStreamID(stream->stream_id))
         return -EINVAL;
 
-    if (stream->stream_id == STREAM_ID_PIP && device_id < SOURCE_VGA) {//for pip stream
-        ALOGD("open_stream:  mPipStreamGivenId = %d, mPipDeviceGivenId = %d\n",
-            priv->mpTv->getPipStreamGivenId(), priv->mpTv->getPipDeviceGivenId());
-        if (stream->stream_id == priv->mpTv->getPipStreamGivenId() && device_id == priv->mpTv->getPipDeviceGivenId()) {
+    // capture has its own context, it must not touch the main/pip ids or the vpp
+    if (stream->stream_id == STREAM_ID_FRAME_CAPTURE) {
+        if (priv->mpTv->getCaptureDeviceGivenId() == device_id) {
+            ALOGD("capture stream has been opened");
+            return -EEXIST;
+        }
+        priv->capWidth = stream->buffer_producer.width;
+        priv->capHeight = stream->buffer_producer.height;
+        stream->type = TV_STREAM_TYPE_BUFFER_PRODUCER;
+        priv->mpTv->setCaptureGivenId(device_id, stream->stream_id);
+        ALOGD("tv_input_open_stream STREAM_ID_FRAME_CAPTURE %dx%d", priv->capWidth, priv->capHeight);
+        return 0;
+    }
+
+    tv_view_t view;
+    bool pipView = stream->stream_id == STREAM_ID_PIP && tvSourceTraits(device_id).pip_capable;
+    if (pipView) {//for pip stream
+        ALOGD("open_stream: %d views opened\n", priv->multiView->count());
+        if (priv->multiView->getView(device_id, stream->stream_id, &view)) {
             ALOGD("pip stream has been opened");
             return -EEXIST;
         }
-    } else if (stream->stream_id == STREAM_ID_MAIN || stream->stream_id != priv->mpTv->getStreamGivenId() ||
-        device_id != priv->mpTv->getDeviceGivenId()) {
-            priv->mpTv->setStreamGivenId(stream->stream_id);
-    } else {
+    } else if (stream->stream_id != STREAM_ID_MAIN && stream->stream_id == priv->mpTv->getStreamGivenId() &&
+        device_id == priv->mpTv->getDeviceGivenId()) {
         ALOGD("stream has been opened");
         return -EEXIST;
     }
 
+    if (admitView(priv, device_id, stream->stream_id) != 0) {
+        return -EBUSY;
+    }
+
     if (getTvStream(priv, stream, device_id) != 0) {
+        priv->multiView->release(device_id, stream->stream_id);
         return -EINVAL;
     }
 
+    // only an admitted stream takes over the given id
+    if (!pipView)
+        priv->mpTv->setStreamGivenId(stream->stream_id);
+
     if (stream->stream_id == STREAM_ID_UNAVAILABLE) {
         // UNAVAILABLE needn't to open source
         priv->mpTv->setDeviceGivenId(device_id);
         return 0;
     }
 
-    if (SOURCE_TV <= device_id && device_id < SOURCE_ADTV) {
-        priv->mpTv->writeSurfaceTypetoVpp(TVIN_SOURCE_TYPE_VDIN);
-    } else if (device_id == SOURCE_DTVKIT) {
-        priv->mpTv->writeSurfaceTypetoVpp(TVIN_SOURCE_TYPE_DECODER);
-    } else {
-        priv->mpTv->writeSurfaceTypetoVpp(TVIN_SOURCE_TYPE_OTHERS);
-    }
+    priv->mpTv->writeSurfaceTypetoVpp(tvSourceTraits(device_id).surface_type);
 
     if (stream->stream_id == STREAM_ID_PIP && (priv->mpTv->IsHdmiPIP(device_id) || priv->mpTv->getCurrentSourceInput() != SOURCE_DTVKIT)) {
-        channelControl(priv, true, device_id, stream->stream_id);
+        if (channelControl(priv, true, device_id, stream->stream_id) != 0) {
+            ALOGW("pip of device %d can not start", device_id);
+            priv->streams->release(device_id, stream->stream_id);
+            priv->multiView->release(device_id, stream->stream_id);
+            return -EBUSY;
+        }
     } else if (stream->stream_id == STREAM_ID_NORMAL || stream->stream_id == STREAM_ID_MAIN || stream->stream_id == STREAM_ID_PIP) {
         if (!channelCheckStatus(priv, 0, device_id) )
             channelControl(priv, true, device_id, stream->stream_id);
-    } else if (stream->stream_id == STREAM_ID_FRAME_CAPTURE) {
-        ALOGE("tv_input_open_stream STREAM_ID_FRAME_CAPTURE is not supported");
-        /*
-        aml_screen_module_t* screenModule;
-        if (hw_get_module(AML_SCREEN_HARDWARE_MODULE_ID, (const hw_module_t **)&screenModule) < 0) {
-            ALOGE("can not get screen source module");
-        } else {
-            screenModule->common.methods->open((const hw_module_t *)screenModule,
-                AML_SCREEN_SOURCE, (struct hw_device_t**)&(priv->mDev));
-            //do test here, we can use ops of mDev to operate vdin source
-        }
-
-        if (priv->mDev) {
-            if (capWidth == 0 || capHeight == 0) {
-                capWidth = stream->buffer_producer.width;
-                capHeight = stream->buffer_producer.height;
-            }
-            priv->mDev->ops.set_format(priv->mDev, capWidth, capHeight, V4L2_PIX_FMT_NV21);
-            priv->mDev->ops.set_port_type(priv->mDev, (int)0x4000); //TVIN_PORT_HDMI0 = 0x4000
-            priv->mDev->ops.start_v4l2_device(priv->mDev);
-        }
-        */
     }
 
     return 0;
@@ -577,6 +602,7 @@ static int tv_input_close_stream(struct tv_input_device *dev, int device_id,
                                  int stream_id)
 {
     tv_input_private_t *priv = (tv_input_private_t *)dev;
+    TV_TRACE_CALL();
 
     if (!priv)
         return -EINVAL;
@@ -584,13 +610,25 @@ static int tv_input_close_stream(struct tv_input_device *dev, int device_id,
     ALOGD("close_stream: device_id = %d, stream_id = %d, mStreamGivenId = %d, mDeviceGivenId = %d\n",
             device_id, stream_id, priv->mpTv->getStreamGivenId(), priv->mpTv->getDeviceGivenId());
 
-    if (!checkDeviceID(device_id) || !checkStreamID(stream_id))
+    if (!checkDeviceID(priv, device_id) || !checkStreamID(stream_id))
         return -EINVAL;
 
-    if (stream_id == STREAM_ID_PIP && device_id < SOURCE_VGA) {//for pip stream
-        ALOGD("close_stream:mPipStreamGivenId = %d, mPipDeviceGivenId = %d\n",
-            priv->mpTv->getPipStreamGivenId(), priv->mpTv->getPipDeviceGivenId());
-        if (!(stream_id == priv->mpTv->getPipStreamGivenId() && device_id == priv->mpTv->getPipDeviceGivenId())) {
+    if (stream_id == STREAM_ID_FRAME_CAPTURE) {
+        if (priv->mpTv->getCaptureDeviceGivenId() != device_id) {
+            ALOGD("capture stream doesn't open");
+            return -EEXIST;
+        }
+        ALOGD("tv_input_close_stream STREAM_ID_FRAME_CAPTURE, flush pending capture");
+        if (priv->captureQueue)
+            priv->captureQueue->flush(device_id, stream_id);
+        priv->mpTv->setCaptureGivenId(-1, -1);
+        return 0;
+    }
+
+    tv_view_t view;
+    if (stream_id == STREAM_ID_PIP && tvSourceTraits(device_id).pip_capable) {//for pip stream
+        ALOGD("close_stream: %d views opened\n", priv->multiView->count());
+        if (!priv->multiView->getView(device_id, stream_id, &view)) {
             ALOGD("pip stream doesn't open, return!");
             return -EEXIST;
         }
@@ -603,11 +641,7 @@ static int tv_input_close_stream(struct tv_input_device *dev, int device_id,
 
     if (stream_id == STREAM_ID_UNAVAILABLE) {
         // UNAVAILABLE needn't to close source, only destroy handle
-        if (pUnavailableTvStream != nullptr) {
-        ALOGD("destroy pUnavailableTvStream");
-        am_gralloc_destroy_sideband_handle((native_handle_t*)pUnavailableTvStream);
-        pUnavailableTvStream = nullptr;
-        }
+        priv->streams->release(device_id, stream_id);
         priv->mpTv->setDeviceGivenId(-1);
         return 0;
     }
@@ -616,92 +650,228 @@ static int tv_input_close_stream(struct tv_input_device *dev, int device_id,
 
     if (stream_id == STREAM_ID_PIP && priv->mpTv->IsHdmiPIP(device_id)) {
             channelControl(priv, false, device_id, stream_id);
-            if (pPipTvStream != nullptr) {
-            ALOGD("close pip, destroy pPipTvStream");
-            am_gralloc_destroy_sideband_handle((native_handle_t*)pPipTvStream);
-            pPipTvStream = nullptr;
-            }
+            ALOGD("close pip, release its view");
+            priv->streams->release(device_id, stream_id);
+            priv->multiView->release(device_id, stream_id);
             return 0;
     } else if (stream_id == STREAM_ID_NORMAL || stream_id == STREAM_ID_MAIN || stream_id == STREAM_ID_PIP) {
-        if (!channelCheckStatus(priv, 1, device_id)) {
+        // handle and view go away with the stream even if the source keeps running,
+        // a handle shared with another opened stream lives on until that one is closed
+        priv->streams->release(device_id, stream_id);
+        priv->multiView->release(device_id, stream_id);
+        if (!channelCheckStatus(priv, 1, device_id))
             channelControl(priv, false, device_id, stream_id);
-            if (pTvStream != nullptr && stream_id == STREAM_ID_NORMAL) {
-                ALOGD("destroy pTvStream");
-                am_gralloc_destroy_sideband_handle((native_handle_t*)pTvStream);
-                pTvStream = nullptr;
-            } else if (pMainTvStream != nullptr && stream_id == STREAM_ID_MAIN) {
-                ALOGD("destroy pMainTvStream");
-                am_gralloc_destroy_sideband_handle((native_handle_t*)pMainTvStream);
-                pMainTvStream = nullptr;
-            } else if (pPipTvStream != nullptr && stream_id == STREAM_ID_PIP) {
-                ALOGD("destroy pPipTvStream");
-                am_gralloc_destroy_sideband_handle((native_handle_t*)pPipTvStream);
-                pPipTvStream = nullptr;
-            } else if (pFixedTvStream != nullptr) {
-                ALOGD("destroy pFixedTvStream");
-                am_gralloc_destroy_sideband_handle((native_handle_t*)pFixedTvStream);
-                pFixedTvStream = nullptr;
-            }
-        }
-        return 0;
-    } else if (stream_id == STREAM_ID_FRAME_CAPTURE) {
-        ALOGD("tv_input_close_stream STREAM_ID_FRAME_CAPTURE is not supported");
-        /*
-        if (priv->mDev) {
-            priv->mDev->ops.stop_v4l2_device(priv->mDev);
-        }*/
         return 0;
     }
     return -EINVAL;
 }
 
+static int lockCaptureBuffer(tv_input_private_t *priv, buffer_handle_t buffer, tv_frame_t *frame)
+{
+    GraphicBufferMapper &mapper = GraphicBufferMapper::get();
+    uint64_t width = priv->capWidth;
+    uint64_t height = priv->capHeight;
+    ui::PixelFormat format = ui::PixelFormat::RGBA_8888;
+
+    mapper.getWidth(buffer, &width);
+    mapper.getHeight(buffer, &height);
+    mapper.getPixelFormatRequested(buffer, &format);
+    if (width == 0 || height == 0) {
+        ALOGE("capture buffer %p has no size", buffer);
+        return -EINVAL;
+    }
+
+    Rect bounds(width, height);
+    frame->width = width;
+    frame->height = height;
+    frame->plane[1] = NULL;
+    frame->stride[1] = 0;
+
+    switch (static_cast<int>(format)) {
+        case HAL_PIXEL_FORMAT_RGBA_8888:
+        case HAL_PIXEL_FORMAT_RGBX_8888:
+        case HAL_PIXEL_FORMAT_RGB_565: {
+            void *vaddr = NULL;
+            int32_t bytesPerPixel = -1;
+            int32_t bytesPerStride = -1;
+            bool rgba = static_cast<int>(format) != HAL_PIXEL_FORMAT_RGB_565;
+            if (mapper.lock(buffer, CAPTURE_GRALLOC_USAGE, bounds, &vaddr,
+                    &bytesPerPixel, &bytesPerStride) != NO_ERROR || vaddr == NULL) {
+                ALOGE("lock capture buffer %p fail", buffer);
+                return -EINVAL;
+            }
+            frame->format = rgba ? TV_FRAME_FORMAT_RGBA8888 : TV_FRAME_FORMAT_RGB565;
+            frame->plane[0] = (uint8_t *)vaddr;
+            frame->stride[0] = bytesPerStride > 0 ? bytesPerStride : width * (rgba ? 4 : 2);
+            return 0;
+        }
+        case HAL_PIXEL_FORMAT_YCrCb_420_SP:
+        case HAL_PIXEL_FORMAT_YCbCr_420_888: {
+            android_ycbcr ycbcr;
+            if (mapper.lockYCbCr(buffer, CAPTURE_GRALLOC_USAGE, bounds, &ycbcr) != NO_ERROR) {
+                ALOGE("lockYCbCr capture buffer %p fail", buffer);
+                return -EINVAL;
+            }
+            if (ycbcr.chroma_step != 2) {
+                ALOGE("capture buffer %p is not semi planar", buffer);
+                mapper.unlock(buffer);
+                return -EINVAL;
+            }
+            bool vFirst = ycbcr.cr < ycbcr.cb;
+            frame->format = vFirst ? TV_FRAME_FORMAT_NV21 : TV_FRAME_FORMAT_NV12;
+            frame->plane[0] = (uint8_t *)ycbcr.y;
+            frame->plane[1] = (uint8_t *)(vFirst ? ycbcr.cr : ycbcr.cb);
+            frame->stride[0] = ycbcr.ystride;
+            frame->stride[1] = ycbcr.cstride;
+            return 0;
+        }
+        default:
+            ALOGE("capture buffer format %d is not supported", static_cast<int>(format));
+            return -EINVAL;
+    }
+}
+
+static int captureFrame(void *data, const tv_capture_request_t &request)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)data;
+    tv_frame_t dst;
+
+    ALOGD("captureFrame device_id:%d, stream_id:%d, buffer:%p, seq:%u",
+            request.device_id, request.stream_id, request.buffer, request.seq);
+
+    int ret = lockCaptureBuffer(priv, request.buffer, &dst);
+    if (ret != 0)
+        return ret;
+
+    ret = priv->frameGrabber->grabInto(&dst);
+    GraphicBufferMapper::get().unlock(request.buffer);
+    return ret;
+}
+
+static void captureComplete(void *data, const tv_capture_request_t &request, int status)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)data;
+
+    if (priv->callback == NULL)
+        return;
+
+    if (status == 0)
+        notifyCaptureSucceeded(priv, request.device_id, request.stream_id, request.seq);
+    else
+        notifyCaptureFail(priv, request.device_id, request.stream_id, request.seq);
+}
+
 static int tv_input_request_capture(
     struct tv_input_device *dev, int device_id,
     int stream_id, buffer_handle_t buffer, uint32_t seq)
 {
-ALOGE("tv_input_request_capture dev:%p, device_id:%x, stream_id:%x, buffer:%p, seq:%x",
-        dev, device_id, stream_id, buffer, seq);
-
-/*
     tv_input_private_t *priv = (tv_input_private_t *)dev;
-    unsigned char *dest = NULL;
-    if (priv->mDev) {
-        aml_screen_buffer_info_t buffInfo = { NULL, 0 ,0 ,0 ,0};
-        int ret = priv->mDev->ops.acquire_buffer(priv->mDev, &buffInfo);
-        if (ret != 0 || (buffInfo.buffer_mem == nullptr)) {
-            ALOGE("Get V4l2 buffer failed");
-            notifyCaptureFail(priv,device_id,stream_id,--seq);
-            return -EWOULDBLOCK;
-        }
-        long *src = (long *)buffInfo.buffer_mem;
-
-        ANativeWindowBuffer *buf = container_of(buffer, ANativeWindowBuffer, handle);
-        sp<GraphicBuffer> graphicBuffer(new GraphicBuffer(buf->handle, GraphicBuffer::WRAP_HANDLE,
-                buf->width, buf->height,
-                buf->format, buf->layerCount,
-                buf->usage, buf->stride));
-        graphicBuffer->lock(SCREENSOURCE_GRALLOC_USAGE, (void **)&dest);
-        if (dest == NULL) {
-            ALOGE("Invalid Gralloc Handle");
-            return -EWOULDBLOCK;
-        }
-        memcpy(dest, src, capWidth*capHeight);
-        graphicBuffer->unlock();
-        graphicBuffer.clear();
-        priv->mDev->ops.release_buffer(priv->mDev, src);
 
-        notifyCaptureSucceeded(priv, device_id, stream_id, seq);
-        return 0;
+    ALOGD("tv_input_request_capture dev:%p, device_id:%d, stream_id:%d, buffer:%p, seq:%u",
+            dev, device_id, stream_id, buffer, seq);
+
+    if (!priv || !priv->captureQueue)
+        return -EINVAL;
+
+    if (!checkDeviceID(priv, device_id) || stream_id != STREAM_ID_FRAME_CAPTURE)
+        return -EINVAL;
+
+    if (priv->mpTv->getCaptureDeviceGivenId() != device_id) {
+        ALOGW("capture stream of device %d is not opened", device_id);
+        return -EINVAL;
     }
-    return -EWOULDBLOCK;
-*/
+
+    return priv->captureQueue->enqueue(device_id, stream_id, buffer, seq);
+}
+
+static int tv_input_cancel_capture(struct tv_input_device *dev, int device_id,
+                                   int stream_id, uint32_t seq)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)dev;
+
+    if (!priv || !priv->captureQueue)
+        return -EINVAL;
+
+    return priv->captureQueue->cancel(device_id, stream_id, seq);
+}
+static int thumbnailActiveSource(void *data)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)data;
+    int stream_id = priv->mpTv->getStreamGivenId();
+
+    if (stream_id != STREAM_ID_NORMAL && stream_id != STREAM_ID_MAIN)
+        return -1;
+    return priv->mpTv->getDeviceGivenId();
+}
+
+int tv_input_get_thumbnail_memory(tv_input_device_t *dev, int *fd, size_t *size)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)dev;
+
+    if (!priv || !priv->thumbnailService)
+        return -EINVAL;
+
+    return priv->thumbnailService->getMemory(fd, size);
+}
+
+int tv_input_refresh_thumbnail(tv_input_device_t *dev, int device_id)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)dev;
+
+    if (!priv || !priv->thumbnailService)
+        return -EINVAL;
+
+    if (!checkDeviceID(priv, device_id))
+        return -EINVAL;
+
+    return priv->thumbnailService->refresh(device_id);
+}
+
+int tv_input_set_message_callback(tv_input_device_t *dev, tv_input_message_cb_t cb, void *data)
+{
+    tv_input_private_t *priv = (tv_input_private_t *)dev;
+
+    if (!priv)
+        return -EINVAL;
+
+    pthread_mutex_lock(&priv->messageLock);
+    priv->message_data = data;
+    priv->messageCallback = cb;
+    pthread_mutex_unlock(&priv->messageLock);
     return 0;
 }
 
-static int tv_input_cancel_capture(struct tv_input_device *, int, int, uint32_t)
+int tv_input_dump(tv_input_device_t *dev, int fd, bool reset)
 {
-    return -EINVAL;
+    tv_input_private_t *priv = (tv_input_private_t *)dev;
+
+    if (!priv)
+        return -EINVAL;
+
+    dprintf(fd, "devices %d:\n", priv->supportDeviceCount);
+    for (int i = 0; i < priv->supportDeviceCount; i++) {
+        const tv_source_traits_t &traits = tvSourceTraits(priv->supportDevices[i]);
+        dprintf(fd, "  %d: type %d hdmi port %d%s%s%s\n", priv->supportDevices[i], traits.type,
+                traits.hdmi_port, traits.hotplug ? " hotplug" : "", traits.demux ? " demux" : "",
+                traits.dtvkit ? " dtvkit" : "");
+    }
+    priv->multiView->dump(fd);
+    priv->tunnels->dump(fd);
+    priv->streams->dump(fd);
+
+    tv_capture_stats_t stats;
+    priv->captureQueue->getStats(&stats);
+    dprintf(fd, "capture %dx%d: depth %d max %d, %u completed %u failed %u cancelled, "
+            "latency last %lldus avg %lldus max %lldus\n", priv->capWidth, priv->capHeight,
+            stats.depth, stats.maxDepth, stats.completed, stats.failed, stats.cancelled,
+            (long long)stats.lastLatencyUs, (long long)stats.avgLatencyUs, (long long)stats.maxLatencyUs);
+    if (reset)
+        priv->captureQueue->resetStats();
+
+    priv->mpTv->dump(fd);
+    return 0;
 }
+
 /*
 static int tv_input_set_capturesurface_size(struct tv_input_device *dev __unused, int width, int height)
 {
@@ -718,6 +888,37 @@ static int tv_input_device_close(struct hw_device_t *dev)
 {
     tv_input_private_t *priv = (tv_input_private_t *)dev;
     if (priv) {
+        if (priv->thumbnailService) {
+            delete priv->thumbnailService;
+            priv->thumbnailService = nullptr;
+        }
+
+        if (priv->captureQueue) {
+            delete priv->captureQueue;
+            priv->captureQueue = nullptr;
+        }
+
+        if (priv->frameGrabber) {
+            delete priv->frameGrabber;
+            priv->frameGrabber = nullptr;
+        }
+
+        // handles and views still hold tunnel references, drop them first
+        if (priv->streams) {
+            delete priv->streams;
+            priv->streams = nullptr;
+        }
+
+        if (priv->multiView) {
+            delete priv->multiView;
+            priv->multiView = nullptr;
+        }
+
+        if (priv->tunnels) {
+            delete priv->tunnels;
+            priv->tunnels = nullptr;
+        }
+
         if (priv->mpTv) {
             delete priv->mpTv;
             priv->mpTv = nullptr;
@@ -733,19 +934,8 @@ static int tv_input_device_close(struct hw_device_t *dev)
             delete priv->eventCallback;
             priv->eventCallback = nullptr;
         }
+        pthread_mutex_destroy(&priv->messageLock);
         free(priv);
-        if (pFixedTvStream) {
-            native_handle_delete((native_handle_t*)pFixedTvStream);
-        }
-        if (pTvStream) {
-            native_handle_delete((native_handle_t*)pTvStream);
-        }
-        if (pMainTvStream) {
-            native_handle_delete((native_handle_t*)pMainTvStream);
-        }
-        if (pPipTvStream) {
-            native_handle_delete((native_handle_t*)pPipTvStream);
-        }
     }
 
     ALOGD("%s", __FUNCTION__);
@@ -764,8 +954,15 @@ int tv_input_device_open(const struct hw_module_t *module,
 
         /* initialize our state here */
         memset(dev, 0, sizeof(*dev));
+        pthread_mutex_init(&dev->messageLock, NULL);
         dev->mpTv = new TvInputIntf();
+        dev->tunnels = new TvTunnelAllocator();
+        dev->multiView = new TvMultiViewManager(dev->mpTv, dev->tunnels);
+        dev->streams = new TvStreamRegistry(dev->tunnels);
         dev->eventCallback = new EventCallback(dev);
+        dev->frameGrabber = new TvFrameGrabber(CAPTURE_SOURCE_WIDTH, CAPTURE_SOURCE_HEIGHT);
+        dev->captureQueue = new TvCaptureQueue(captureFrame, captureComplete, dev);
+        dev->thumbnailService = new TvThumbnailService(dev->frameGrabber, thumbnailActiveSource, dev);
         /* initialize the procs */
         dev->device.common.tag = HARDWARE_DEVICE_TAG;
         dev->device.common.version = TV_INPUT_DEVICE_API_VERSION_0_1;
@@ -27,6 +27,13 @@
 #endif
 
 #include "TvInputIntf.h"
+#include "TvSourceTraits.h"
+#include "TvCaptureQueue.h"
+#include "TvFrameGrabber.h"
+#include "TvThumbnailService.h"
+#include "TvTunnelAllocator.h"
+#include "TvMultiViewManager.h"
+#include "TvStreamRegistry.h"
 //#include "aml_screen.h"
 #include <hardware/tv_input.h>
 
@@ -49,10 +56,27 @@ public:
     ~EventCallback() {}
 
     void onTvEvent (const source_connect_t &scrConnect);
+    void onTvMessage (const tv_parcel_t &parcel);
 private:
     void *mPri;
 };
 
+/* values match android.hardware.tv.input.TvMessageEventType */
+enum {
+    TV_INPUT_MESSAGE_WATERMARK      = 1,
+    TV_INPUT_MESSAGE_CLOSED_CAPTION = 2,
+};
+
+/*
+ * payload holds one data byte per element, as tvserver sends it, so the
+ * receiver narrows it straight into its own buffer without a staging copy.
+ */
+typedef void (*tv_input_message_cb_t)(void *data, int device_id, int stream_id, int type,
+        const int32_t *payload, size_t size);
+
+/* tvserver reports at most this many source ids */
+#define TV_INPUT_MAX_DEVICES 20
+
 typedef struct tv_input_private {
     tv_input_device_t device;
     const tv_input_callback_ops_t *callback;
@@ -60,6 +84,20 @@ typedef struct tv_input_private {
     //aml_screen_device_t *mDev;
     TvInputIntf *mpTv;
     EventCallback *eventCallback;
+    TvCaptureQueue *captureQueue;
+    TvFrameGrabber *frameGrabber;
+    TvThumbnailService *thumbnailService;
+    TvTunnelAllocator *tunnels;
+    TvMultiViewManager *multiView;
+    TvStreamRegistry *streams;
+    pthread_mutex_t messageLock;    /* messageCallback and message_data change together */
+    tv_input_message_cb_t messageCallback;
+    void *message_data;
+    int supportDevices[TV_INPUT_MAX_DEVICES];
+    int supportDeviceCount;
+    bool hotplugDetect;             /* source events are only handled with hdmi/av hotplug detect on */
+    int capWidth;                   /* size of the STREAM_ID_FRAME_CAPTURE buffers */
+    int capHeight;
 } tv_input_private_t;
 
 enum {
@@ -70,10 +108,31 @@ enum {
     STREAM_ID_UNAVAILABLE   = 5,
 };
 
-void channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int stream_id);
+int channelControl(tv_input_private_t *priv, bool opsStart, int device_id, int stream_id);
 int notifyDeviceStatus(tv_input_private_t *priv, tv_source_input_t inputSrc, int type);
 void initTvDevices(tv_input_private_t *priv);
 
+/*
+ * Vendor extension, not part of tv_input_device_t.  The memory is laid out
+ * as described in TvThumbnailService.h; fd is a dup the caller must close.
+ * refresh returns -EAGAIN when device_id is not the source on screen.
+ */
+int tv_input_get_thumbnail_memory(tv_input_device_t *dev, int *fd, size_t *size);
+int tv_input_refresh_thumbnail(tv_input_device_t *dev, int device_id);
+
+/*
+ * Vendor extension, delivers TvMessage payloads (closed caption data from
+ * tvserver) of the main stream.  Called on the tvserver callback thread.
+ */
+int tv_input_set_message_callback(tv_input_device_t *dev, tv_input_message_cb_t cb, void *data);
+
+/*
+ * Vendor extension for dumpsys: devices, views, tunnels, stream handles, the
+ * capture queue and the tvserver session.  reset clears the capture counters
+ * after they are printed.
+ */
+int tv_input_dump(tv_input_device_t *dev, int fd, bool reset);
+
 int tv_input_device_open(const struct hw_module_t *module,
                                 const char *name, struct hw_device_t **device);
 
@@ -46,16 +46,21 @@ public:
 
     status_t processCmd(const Parcel &p, Parcel *r)
     {
-        Parcel data, reply;
-        data.writeInterfaceToken(ITv::getInterfaceDescriptor());
+        Parcel data;
+        writeCmdHeader(&data);
         data.write(p.data(), p.dataSize());
-        if (remote()->transact(TV_CMD, data, &reply) == NO_ERROR) {
-            r->write(reply.data(), reply.dataSize());
-            r->setDataPosition(0);
-        } else {
+        transactCmd(data, r);
+        return 0;
+    }
+
+    status_t transactCmd(const Parcel &data, Parcel *r)
+    {
+        // the driver hands the reply buffer to r, nothing to copy back
+        status_t ret = remote()->transact(TV_CMD, data, r);
+        if (ret != NO_ERROR) {
             ALOGV("%s failed!\n", __FUNCTION__);
         }
-        return 0;
+        return ret;
     }
 
     virtual status_t createVideoFrame(const sp<IMemory> &share_mem, int iSourceMode, int iCapVideoLayerOnly)
@@ -115,6 +120,22 @@ public:
 
 IMPLEMENT_META_INTERFACE(Tv, "android.amlogic.ITv");
 
+void ITv::writeCmdHeader(Parcel *data)
+{
+    data->writeInterfaceToken(ITv::getInterfaceDescriptor());
+}
+
+// local ITv, run the command in place like BnTv does for TV_CMD
+status_t ITv::transactCmd(const Parcel &data, Parcel *r)
+{
+    data.setDataPosition(0);
+    if (!data.enforceInterface(ITv::getInterfaceDescriptor()))
+        return PERMISSION_DENIED;
+    status_t ret = processCmd(data, r);
+    r->setDataPosition(0);
+    return ret;
+}
+
 status_t BnTv::onTransact(
     uint32_t code, const Parcel &data, Parcel *reply, uint32_t flags)
 {
@@ -38,18 +38,25 @@ public:
 
 IMPLEMENT_META_INTERFACE(TvClient, "android.amlogic.ITvClient");
 
+void ITvClient::notifyCallbackInPlace(int32_t msgType, const Parcel &p)
+{
+    Parcel ext;
+    ext.appendFrom(const_cast<Parcel *>(&p), p.dataPosition(), p.dataAvail());
+    ext.setDataPosition(0);
+    notifyCallback(msgType, ext);
+}
+
 // ----------------------------------------------------------------------
 status_t BnTvClient::onTransact(uint32_t code, const Parcel &data, Parcel *reply, uint32_t flags)
 {
     switch (code) {
     case NOTIFY_CALLBACK: {
         CHECK_INTERFACE(ITvClient, data, reply);
-        Parcel ext;
         int32_t msgType = data.readInt32();
         ALOGV("BnTvClient::onTransact NOTIFY_CALLBACK msg type :%d", msgType);
 
-        ext.appendFrom(const_cast<Parcel *>(&data), data.dataPosition(), data.dataAvail());
-        notifyCallback(msgType, ext);
+        // hand over the transaction parcel itself, positioned at the payload
+        notifyCallbackInPlace(msgType, data);
         return NO_ERROR;
     }
     break;
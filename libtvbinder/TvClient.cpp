@@ -9,12 +9,15 @@
 
 #define LOG_TAG "TvClient"
 #include <log/log.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
 #include <utils/threads.h>
-#include <signal.h>
 #include <binder/IServiceManager.h>
 #include <binder/IMemory.h>
 
 #include "include/TvClient.h"
+#include "include/TvCmd.h"
 #include "include/ITvService.h"
 
 // client singleton for tv service binder interface
@@ -65,6 +68,8 @@ sp<TvClient> TvClient::create(const sp<ITv> &tv)
         c->mStatus = NO_ERROR;
         c->mTv = tv;
         IInterface::asBinder(tv)->linkToDeath(c);
+        c->attachSettingsMirror(tv);
+        c->enableSettingsCache(tv);
     }
     return c;
 }
@@ -72,6 +77,12 @@ sp<TvClient> TvClient::create(const sp<ITv> &tv)
 void TvClient::init()
 {
     mStatus = UNKNOWN_ERROR;
+    mPqProfileUnsupported = false;
+    mReconnecting = false;
+    mClosed = false;
+    mReconnectWait = 0;
+    mDiedAt = 0;
+    memset(&mReconnectStats, 0, sizeof(mReconnectStats));
 }
 
 TvClient::~TvClient()
@@ -90,6 +101,8 @@ sp<TvClient> TvClient::connect()
     if (c->mTv != 0) {
         IInterface::asBinder(c->mTv)->linkToDeath(c);
         c->mStatus = NO_ERROR;
+        c->attachSettingsMirror(c->mTv);
+        c->enableSettingsCache(c->mTv);
     } else {
         c.clear();
     }
@@ -99,61 +112,277 @@ sp<TvClient> TvClient::connect()
 void TvClient::disconnect()
 {
     ALOGD("disconnect");
-    if (mTv != 0) {
-        mTv->disconnect();
-        IInterface::asBinder(mTv)->unlinkToDeath(this);
+    sp<ITv> tv;
+    {
+        Mutex::Autolock _l(mTvLock);
+        tv = mTv;
         mTv = 0;
+        mClosed = true;
+        mReconnecting = false;
+        mTvCond.broadcast();
+    }
+    if (tv != 0) {
+        tv->disconnect();
+        IInterface::asBinder(tv)->unlinkToDeath(this);
     }
 }
 
 status_t TvClient::reconnect()
 {
     ALOGD("reconnect");
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
     return c->connect(this);
 }
 
 sp<ITv> TvClient::remote()
 {
+    Mutex::Autolock _l(mTvLock);
     return mTv;
 }
 
+status_t TvClient::getTv(sp<ITv> *tv)
+{
+    Mutex::Autolock _l(mTvLock);
+    if (mTv == 0 && mReconnecting && mReconnectWait > 0) {
+        nsecs_t deadline = systemTime() + mReconnectWait;
+        while (mTv == 0 && mReconnecting) {
+            nsecs_t left = deadline - systemTime();
+            if (left <= 0 || mTvCond.waitRelative(mTvLock, left) == TIMED_OUT)
+                break;
+        }
+    }
+    *tv = mTv;
+    if (mTv != 0)
+        return NO_ERROR;
+    return mReconnecting ? DEAD_OBJECT : NO_INIT;
+}
+
+void TvClient::setReconnectWait(nsecs_t waitNs)
+{
+    Mutex::Autolock _l(mTvLock);
+    mReconnectWait = waitNs;
+}
+
+void TvClient::getReconnectStats(tv_reconnect_stats_t *stats)
+{
+    Mutex::Autolock _l(mTvLock);
+    *stats = mReconnectStats;
+}
+
 status_t TvClient::lock()
 {
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
     return c->lock();
 }
 
 status_t TvClient::unlock()
 {
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
     return c->unlock();
 }
 
 status_t TvClient::processCmd(const Parcel &p, Parcel *r)
 {
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
-    return c->processCmd(p, r);
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
+
+    uint32_t gen;
+    int32_t cmd = TvSettingsCache::opcodeOf(p);
+    if (!TvSettingsCache::isCacheable(cmd)) {
+        if (!TvSettingsCache::isReadOnly(cmd))
+            mSettingsCache.invalidate();
+        return c->processCmd(p, r);
+    }
+    if (mSettingsMirror.lookup(p, r))
+        return NO_ERROR;
+    if (mSettingsCache.lookup(p, r, &gen))
+        return NO_ERROR;
+    status_t ret = c->processCmd(p, r);
+    if (ret == NO_ERROR && r->dataSize() > 0)
+        mSettingsCache.store(p, *r, gen);
+    return ret;
+}
+
+status_t TvClient::transactCmd(const Parcel &data, Parcel *r, int32_t cmd)
+{
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
+    // not read through the cache, but a setter still has to drop it
+    if (!TvSettingsCache::isCacheable(cmd) && !TvSettingsCache::isReadOnly(cmd))
+        mSettingsCache.invalidate();
+    return c->transactCmd(data, r);
+}
+
+void TvClient::getSettingsCacheStats(tv_settings_cache_stats_t *stats)
+{
+    mSettingsCache.getStats(stats);
+}
+
+// the tvserver side stays optional, without it every read is a processCmd
+void TvClient::attachSettingsMirror(const sp<ITv> &tv)
+{
+    Parcel p, r;
+    p.writeInt32(GET_SETTINGS_MIRROR);
+    if (tv->processCmd(p, &r) != NO_ERROR)
+        return;
+    r.setDataPosition(0);
+    status_t ret = mSettingsMirror.attach(r);
+    ALOGW_IF(ret != NO_ERROR && ret != NAME_NOT_FOUND, "settings mirror not attached: %d", ret);
+}
+
+// only a tvserver that pushes SETTINGS_CHANGED_CALLBACK keeps the cache coherent
+void TvClient::enableSettingsCache(const sp<ITv> &tv)
+{
+    Parcel p, r;
+    int32_t version = 0;
+    p.writeInt32(GET_SETTINGS_CHANGED_VERSION);
+    if (tv->processCmd(p, &r) == NO_ERROR && r.dataSize() >= sizeof(int32_t)) {
+        r.setDataPosition(0);
+        version = r.readInt32();
+    }
+    mSettingsCache.setEnabled(version >= TV_SETTINGS_CHANGED_VERSION);
+    ALOGI("settings cache %s, tvserver change version %d",
+            version >= TV_SETTINGS_CHANGED_VERSION ? "on" : "off", version);
+}
+
+status_t TvClient::getSetting(int32_t cmd, int32_t source, int32_t *value)
+{
+    bool hasSource = false;
+    int slot = TvSettingsMirror::slotOf(cmd, &hasSource);
+    if (slot < 0)
+        return BAD_VALUE;
+    if (mSettingsMirror.read(slot, source, value))
+        return NO_ERROR;
+
+    Parcel p, r;
+    p.writeInt32(cmd);
+    if (hasSource)
+        p.writeInt32(source);
+    status_t ret = processCmd(p, &r);
+    if (ret != NO_ERROR)
+        return ret;
+    if (r.dataSize() < sizeof(int32_t))
+        return UNKNOWN_ERROR;
+    *value = r.readInt32();
+    return NO_ERROR;
+}
+
+// one transaction per field, what callers did before SET_PQ_PROFILE
+// tvserver answers every SET_* with its own result, 0 when the value was taken
+template <int Op>
+static status_t applyPqField(const sp<TvClient> &client, const tv_pq_profile_t &profile, int32_t value)
+{
+    int32_t reply = 0;
+    status_t ret = TvCmd<Op>::call(client, &reply, value, profile.source, profile.save);
+    return ret != NO_ERROR ? ret : reply;
+}
+
+// stops at the first field that fails, the ones before it stay applied
+static status_t applyPqFields(const sp<TvClient> &client, const tv_pq_profile_t &profile)
+{
+    status_t ret = NO_ERROR;
+
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_BRIGHTNESS))
+        ret = applyPqField<SET_BRIGHTNESS>(client, profile, profile.brightness);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_CONTRAST))
+        ret = applyPqField<SET_CONTRAST>(client, profile, profile.contrast);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_SATURATION))
+        ret = applyPqField<SET_SATURATION>(client, profile, profile.saturation);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_HUE))
+        ret = applyPqField<SET_HUE>(client, profile, profile.hue);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_SHARPNESS))
+        ret = applyPqField<SET_SHARPNESS>(client, profile, profile.sharpness);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_BACKLIGHT))
+        ret = applyPqField<SET_BACKLIGHT>(client, profile, profile.backlight);
+    if (ret == NO_ERROR && (profile.mask & TV_PQ_FIELD_COLOR_TEMPERATURE))
+        ret = applyPqField<SET_COLOR_TEMPERATURE>(client, profile, profile.colorTemperature);
+    return ret;
+}
+
+status_t TvClient::applyPqProfile(const tv_pq_profile_t &profile)
+{
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
+
+    if (!mPqProfileUnsupported) {
+        Parcel data, r;
+        ITv::writeCmdHeader(&data);
+        data.writeInt32(SET_PQ_PROFILE);
+        data.writeInt32(TV_PQ_PROFILE_VERSION);
+        data.writeInt32(profile.source);
+        data.writeInt32(profile.save);
+        data.writeInt32(profile.mask);
+        data.writeInt32(profile.brightness);
+        data.writeInt32(profile.contrast);
+        data.writeInt32(profile.saturation);
+        data.writeInt32(profile.hue);
+        data.writeInt32(profile.sharpness);
+        data.writeInt32(profile.backlight);
+        data.writeInt32(profile.colorTemperature);
+
+        mSettingsCache.invalidate();
+        status_t ret = c->transactCmd(data, &r);
+        if (ret != NO_ERROR)
+            return ret;
+        // a tvserver without SET_PQ_PROFILE leaves the reply empty
+        if (r.dataAvail() >= sizeof(int32_t))
+            return r.readInt32();
+        ALOGW("tvserver has no SET_PQ_PROFILE, apply the fields one by one");
+        mPqProfileUnsupported = true;
+    }
+    return applyPqFields(this, profile);
 }
 
 status_t TvClient::createSubtitle(const sp<IMemory> &share_mem)
 {
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
     return c->createSubtitle(share_mem);
 }
 
+sp<TvSubtitleRing> TvClient::createSubtitleRing(int width, int height, int slots)
+{
+    sp <ITv> c;
+    if (getTv(&c) != NO_ERROR) return NULL;
+
+    // older tvservers treat the memory as a plain bitmap, don't hand them a ring
+    Parcel p, r;
+    p.writeInt32(DTV_SUBTITLE_RING_VERSION);
+    if (c->processCmd(p, &r) != NO_ERROR || r.dataSize() < sizeof(int32_t))
+        return NULL;
+    r.setDataPosition(0);
+    if (r.readInt32() < TV_SUBTITLE_RING_VERSION)
+        return NULL;
+
+    sp<TvSubtitleRing> ring = TvSubtitleRing::create(width, height, slots);
+    if (ring == NULL || c->createSubtitle(ring->memory()) != NO_ERROR)
+        return NULL;
+    return ring;
+}
+
 status_t TvClient::createVideoFrame(const sp<IMemory> &share_mem, int iSourceMode, int iCapVideoLayerOnly)
 {
-    sp <ITv> c = mTv;
-    if (c == 0) return NO_INIT;
+    sp <ITv> c;
+    status_t status = getTv(&c);
+    if (status != NO_ERROR) return status;
     return c->createVideoFrame(share_mem, iSourceMode, iCapVideoLayerOnly);
 }
 
+sp<TvVideoFrameSession> TvClient::createVideoFrameSession(size_t frameSize, int slots)
+{
+    return TvVideoFrameSession::create(this, frameSize, slots);
+}
+
 void TvClient::setListener(const sp<TvListener> &listener)
 {
     ALOGD("tv------------Tv::setListener");
@@ -161,33 +390,160 @@ void TvClient::setListener(const sp<TvListener> &listener)
     mListener = listener;
 }
 
-// callback from tv service
+void TvListener::notifyInPlace(int32_t msgType, const Parcel &ext)
+{
+    Parcel payload;
+    payload.appendFrom(const_cast<Parcel *>(&ext), ext.dataPosition(), ext.dataAvail());
+    payload.setDataPosition(0);
+    notify(msgType, payload);
+}
+
 void TvClient::notifyCallback(int32_t msgType, const Parcel &p)
 {
     p.setDataPosition(0);
+    notifyCallbackInPlace(msgType, p);
+}
+
+// callback from tv service, p is left at the start of the payload
+void TvClient::notifyCallbackInPlace(int32_t msgType, const Parcel &p)
+{
+    if (msgType == SETTINGS_CHANGED_CALLBACK) {
+        size_t pos = p.dataPosition();
+        mSettingsCache.invalidate(p.readInt32());
+        p.setDataPosition(pos);
+    }
+
     sp<TvListener> listener;
     {
         Mutex::Autolock _l(mLock);
         listener = mListener;
     }
     if (listener != NULL) {
-        listener->notify(msgType, p);
+        listener->notifyInPlace(msgType, p);
     }
 }
 
 void TvClient::binderDied(const wp<IBinder> &who __unused)
 {
     ALOGW("ITv died");
-    //notifyCallback(1, 2, 0);
+    mSettingsMirror.detach();
+    // the restarted tvserver may not send SETTINGS_CHANGED_CALLBACK
+    mSettingsCache.setEnabled(false);
+
+    {
+        Mutex::Autolock _l(mTvLock);
+        if (mClosed || mReconnecting)
+            return;
+        mTv = 0;
+        mStatus = DEAD_OBJECT;
+        mReconnecting = true;
+        mDiedAt = systemTime();
+        mReconnectStats.deaths++;
+    }
+
+    // polls until tvservice is back, keep it off the binder thread
+    wp<TvClient> *weak = new wp<TvClient>(this);
+    if (!createThreadEtc(reconnectThread, weak, "TvClientReconnect")) {
+        ALOGE("start reconnect thread fail");
+        delete weak;
+        Mutex::Autolock _l(mTvLock);
+        mReconnecting = false;
+        mTvCond.broadcast();
+    }
+}
+
+// one look for tvservice without waiting, so mLock is never held while it is down
+sp<ITvService> TvClient::checkTvService()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        if (mTvService != 0 && IInterface::asBinder(mTvService)->isBinderAlive())
+            return mTvService;
+    }
+
+    sp<IBinder> binder = defaultServiceManager()->checkService(String16("tvservice"));
+    if (binder == 0 || !binder->isBinderAlive())
+        return NULL;
+
+    Mutex::Autolock _l(mLock);
+    // the old service may not have been dropped by DeathNotifier yet
+    if (mTvService == 0 || !IInterface::asBinder(mTvService)->isBinderAlive()) {
+        if (mDeathNotifier == NULL)
+            mDeathNotifier = new DeathNotifier();
+        binder->linkToDeath(mDeathNotifier);
+        mTvService = interface_cast<ITvService>(binder);
+    }
+    return mTvService;
+}
+
+int TvClient::reconnectThread(void *arg)
+{
+    wp<TvClient> weak = *(wp<TvClient> *)arg;
+    delete (wp<TvClient> *)arg;
+
+    while (true) {
+        // released or disconnected while tvservice was down, nothing to wait for
+        {
+            sp<TvClient> c = weak.promote();
+            if (c == 0)
+                return 0;
+            Mutex::Autolock _l(c->mTvLock);
+            if (c->mClosed)
+                return 0;
+        }
+
+        sp<ITvService> cs = checkTvService();
+        if (cs != 0) {
+            sp<TvClient> c = weak.promote();
+            if (c == 0 || c->finishReconnect(cs))
+                return 0;
+        }
+        usleep(200000); // 0.2 s
+    }
+}
+
+// true when done, false to try again
+bool TvClient::finishReconnect(const sp<ITvService> &cs)
+{
+    {
+        Mutex::Autolock _l(mTvLock);
+        if (mClosed)
+            return true;
+    }
+
+    sp<ITv> tv = cs->connect(this);
+    if (tv == 0) {
+        ALOGW("tvservice refused the reconnect");
+        return false;
+    }
+    IInterface::asBinder(tv)->linkToDeath(this);
+    attachSettingsMirror(tv);
+    enableSettingsCache(tv);
+
+    Mutex::Autolock _l(mTvLock);
+    if (mClosed) {
+        IInterface::asBinder(tv)->unlinkToDeath(this);
+        tv->disconnect();
+        return true;
+    }
+    mTv = tv;
+    mStatus = NO_ERROR;
+    mReconnecting = false;
+    nsecs_t latency = systemTime() - mDiedAt;
+    mReconnectStats.reconnects++;
+    mReconnectStats.lastLatency = latency;
+    if (latency > mReconnectStats.maxLatency)
+        mReconnectStats.maxLatency = latency;
+    mTvCond.broadcast();
+    ALOGI("reconnected to tvservice in %" PRId64 " ms", ns2ms(latency));
+    return true;
 }
 
+// only drops the cached service, each TvClient reconnects on its own ITv death
 void TvClient::DeathNotifier::binderDied(const wp<IBinder> &who __unused)
 {
-    ALOGW("-----------------binderDied");
+    ALOGW("tvservice died");
     Mutex::Autolock _l(TvClient::mLock);
     TvClient::mTvService.clear();
-    ALOGW("kill myself");
-    kill(getpid(), SIGKILL);
-    ALOGW("----------------Tv server died!");
 }
 
@@ -21,9 +21,12 @@
 
 #define LOG_TAG "TvServerHidlClient"
 #include <log/log.h>
+#include <stdio.h>
 #include "unistd.h"
 
 #include "include/TvServerHidlClient.h"
+#include "include/tvcmd.h"
+#include "include/TvTrace.h"
 
 namespace android {
 
@@ -112,6 +115,11 @@ void TvServerHidlClient::reconnect()
             ALOGE("Failed to setCallback %s", setup.description().c_str());
         }
     }
+    // pushes sent while tvserver was gone are lost, read it again when asked
+    storeSignalSnapshot(nullptr);
+    mSignalPushed = false;
+    mSignalVersion++;
+    mReconnects++;
 }
 
 void TvServerHidlClient::disconnect()
@@ -167,6 +175,7 @@ void TvServerHidlClient::setListener(const sp<TvListener> &listener)
 }
 
 int TvServerHidlClient::startTv() {
+    TV_TRACE_CALL();
     Return<int32_t> ret = mTvServer->startTv();
     if (!ret.isOk()) {
         ALOGE("startTv error");
@@ -175,6 +184,7 @@ int TvServerHidlClient::startTv() {
 }
 
 int TvServerHidlClient::stopTv() {
+    TV_TRACE_CALL();
     Return<int32_t> ret = mTvServer->stopTv();
     if (!ret.isOk()) {
         ALOGE("stopTv error");
@@ -191,6 +201,7 @@ int TvServerHidlClient::setTunnelId(int tunnelId) {
 }
 
 int TvServerHidlClient::switchInputSrc(int32_t inputSrc) {
+    TV_TRACE_CALL();
     //return mTvServer->switchInputSrc(inputSrc);
     Return<int32_t> ret = mTvServer->switchInputSrc(inputSrc);
     if (!ret.isOk()) {
@@ -248,7 +259,57 @@ int TvServerHidlClient::getHdmiPorts(int32_t inputSrc) {
     return ret;
 }
 
+void TvServerHidlClient::subscribeSignalInfo(bool enable) {
+    mSignalSubscribed = enable;
+    if (!enable)
+        storeSignalSnapshot(nullptr);
+}
+
+uint32_t TvServerHidlClient::getSignalInfoVersion() {
+    return mSignalVersion;
+}
+
+// bumps the generation before the store, so a poll that started earlier sees it
+void TvServerHidlClient::storeSignalSnapshot(std::shared_ptr<const signal_snapshot_t> snapshot) {
+    mSignalGeneration++;
+    std::atomic_store(&mSignalSnapshot, snapshot);
+}
+
+/*
+ * A push that lands while polling wins over the polled values, and so does
+ * an invalidation: the polled values may predate it, so they are returned
+ * to this caller but not kept for the next one.
+ */
+std::shared_ptr<const TvServerHidlClient::signal_snapshot_t> TvServerHidlClient::refreshSignalSnapshot() {
+    uint32_t generation = mSignalGeneration;
+    std::shared_ptr<const signal_snapshot_t> expected;
+    std::shared_ptr<signal_snapshot_t> polled = std::make_shared<signal_snapshot_t>();
+    polled->signal = pollSignalInfo();
+    polled->format = pollHdmiFormatInfo();
+
+    std::shared_ptr<const signal_snapshot_t> snapshot = polled;
+    if (!std::atomic_compare_exchange_strong(&mSignalSnapshot, &expected, snapshot))
+        return expected;
+    // invalidated since the poll started, unless a push replaced it already
+    if (mSignalGeneration != generation) {
+        expected = snapshot;
+        std::atomic_compare_exchange_strong(&mSignalSnapshot, &expected,
+                std::shared_ptr<const signal_snapshot_t>());
+    }
+    return snapshot;
+}
+
 SignalInfo TvServerHidlClient::getCurSignalInfo() {
+    if (mSignalSubscribed) {
+        std::shared_ptr<const signal_snapshot_t> snapshot = std::atomic_load(&mSignalSnapshot);
+        if (snapshot == nullptr)
+            snapshot = refreshSignalSnapshot();
+        return snapshot->signal;
+    }
+    return pollSignalInfo();
+}
+
+SignalInfo TvServerHidlClient::pollSignalInfo() {
     SignalInfo signalInfo;
     Return<void> ret = mTvServer->getCurSignalInfo([&](const SignalInfo& info) {
         signalInfo.fmt = info.fmt;
@@ -287,6 +348,7 @@ int TvServerHidlClient::loadEdidData(int32_t isNeedBlackScreen, int32_t isDolbyV
     Return<int32_t> ret = mTvServer->loadEdidData(isNeedBlackScreen, isDolbyVisionEnable);
     if (!ret.isOk()) {
         ALOGE("loadEdidData error");
+        return -1;
     }
     return ret;
 }
@@ -296,6 +358,7 @@ int TvServerHidlClient::updateEdidData(int32_t inputSrc, const std::string& edid
     Return<int32_t> ret = mTvServer->updateEdidData(inputSrc, edidData);
     if (!ret.isOk()) {
         ALOGE("updateEdidData error");
+        return -1;
     }
     return ret;
 }
@@ -305,6 +368,7 @@ int TvServerHidlClient::setHdmiEdidVersion(int32_t port_id, int32_t ver) {
     Return<int32_t> ret = mTvServer->setHdmiEdidVersion(port_id, ver);
     if (!ret.isOk()) {
         ALOGE("setHdmiEdidVersion error");
+        return -1;
     }
     return ret;
 }
@@ -313,7 +377,8 @@ int TvServerHidlClient::getHdmiEdidVersion(int32_t port_id) {
     //return mTvServer->getHdmiEdidVersion(port_id);
     Return<int32_t> ret = mTvServer->getHdmiEdidVersion(port_id);
     if (!ret.isOk()) {
-        ALOGE("setHdmiEdidVersion error");
+        ALOGE("getHdmiEdidVersion error");
+        return -1;
     }
     return ret;
 }
@@ -346,6 +411,16 @@ int TvServerHidlClient::getHdmiColorRangeMode() {
 }
 
 FormatInfo TvServerHidlClient::getHdmiFormatInfo() {
+    if (mSignalSubscribed) {
+        std::shared_ptr<const signal_snapshot_t> snapshot = std::atomic_load(&mSignalSnapshot);
+        if (snapshot == nullptr)
+            snapshot = refreshSignalSnapshot();
+        return snapshot->format;
+    }
+    return pollHdmiFormatInfo();
+}
+
+FormatInfo TvServerHidlClient::pollHdmiFormatInfo() {
     FormatInfo info;
     Return<void> ret = mTvServer->getHdmiFormatInfo([&](const FormatInfo formatInfo) {
         info.width     = formatInfo.width;
@@ -442,6 +517,7 @@ BasicVdecState TvServerHidlClient::getBasicVdecStatusInfo(int vdecId) {
 }
 
 int TvServerHidlClient::StartTvInPIP( int32_t source_input ) {
+    TV_TRACE_CALL();
     Return<int32_t> ret = mTvServer->StartTvInPIP(source_input);
     if (!ret.isOk()) {
         ALOGE("StartTvInPIP error");
@@ -467,11 +543,49 @@ int TvServerHidlClient::IsSupportPIP() {
     return ret;
 }
 
+void TvServerHidlClient::dump(int fd) {
+    dprintf(fd, "tvserver client type %d: %s, %u reconnects\n", mType,
+            mTvServer != nullptr ? "connected" : "disconnected", mReconnects.load());
+    dprintf(fd, "  signal info %s, %s, version %u\n", mSignalSubscribed ? "subscribed" : "polled",
+            mSignalPushed ? "pushed" : "nothing pushed", mSignalVersion.load());
+}
+
+
+void TvServerHidlClient::onSignalEvent(const TvHidlParcel &parcel) {
+    if (!mSignalSubscribed)
+        return;
+
+    if (parcel.msgType == SIGNAL_INFO_CHANGED_CALLBACK) {
+        if (parcel.bodyInt.size() < 8) {
+            ALOGE("short signal info event, %zu ints", parcel.bodyInt.size());
+            return;
+        }
+        std::shared_ptr<signal_snapshot_t> snapshot = std::make_shared<signal_snapshot_t>();
+        snapshot->signal.fmt       = static_cast<decltype(snapshot->signal.fmt)>(parcel.bodyInt[0]);
+        snapshot->signal.transFmt  = static_cast<decltype(snapshot->signal.transFmt)>(parcel.bodyInt[1]);
+        snapshot->signal.status    = static_cast<decltype(snapshot->signal.status)>(parcel.bodyInt[2]);
+        snapshot->signal.frameRate = static_cast<decltype(snapshot->signal.frameRate)>(parcel.bodyInt[3]);
+        snapshot->format.width     = parcel.bodyInt[4];
+        snapshot->format.height    = parcel.bodyInt[5];
+        snapshot->format.fps       = parcel.bodyInt[6];
+        snapshot->format.interlace = parcel.bodyInt[7];
+        storeSignalSnapshot(snapshot);
+        mSignalPushed = true;
+        mSignalVersion++;
+    } else if ((parcel.msgType == SIGNAL_DETECT_CALLBACK || parcel.msgType == SOURCE_SWITCH_CALLBACK)
+               && !mSignalPushed) {
+        // tvserver without the push, poll again on the next read
+        storeSignalSnapshot(nullptr);
+        mSignalVersion++;
+    }
+}
 
 // callback from tv service
 Return<void> TvServerHidlClient::TvServerHidlCallback::notifyCallback(const TvHidlParcel& hidlParcel)
 {
+    TV_TRACE_CALL();
     ALOGI("notifyCallback event type:%d", hidlParcel.msgType);
+    tvserverClient->onSignalEvent(hidlParcel);
 
 #if 0
     Parcel p;
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#define LOG_TAG "TvSettingsCache"
+#include <log/log.h>
+#include <string.h>
+
+#include "include/TvSettingsCache.h"
+#include "include/tvcmd.h"
+
+// keeps a settings menu worth of getters, more means someone is scanning
+#define SETTINGS_CACHE_MAX_ENTRIES 256
+
+TvSettingsCache::TvSettingsCache()
+    : mEnabled(false),
+      mGeneration(0)
+{
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+int32_t TvSettingsCache::opcodeOf(const Parcel &p)
+{
+    int32_t cmd = -1;
+    if (p.dataSize() >= sizeof(cmd))
+        memcpy(&cmd, p.data(), sizeof(cmd));
+    return cmd;
+}
+
+bool TvSettingsCache::isCacheable(int32_t cmd)
+{
+    switch (cmd) {
+    case GET_BRIGHTNESS:
+    case GET_CONTRAST:
+    case GET_SATURATION:
+    case GET_HUE:
+    case GET_PQMODE:
+    case GET_SHARPNESS:
+    case GET_BACKLIGHT:
+    case GET_COLOR_MODE:
+    case GET_COLOR_TEMPERATURE:
+    case GET_DISPLAY_MODE:
+    case GET_NOISE_REDUCTION_MODE:
+    case GET_BACKLIGHT_SWITCH:
+    case GET_EYE_PROTECTION_MODE:
+    case GET_AUDIO_MUTEKEY_STATUS:
+    case GET_AUDIO_MASTER_VOLUME:
+    case GET_CUR_AUDIO_MASTER_VOLUME:
+    case GET_AUDIO_BALANCE:
+    case GET_CUR_AUDIO_BALANCE:
+    case GET_AUDIO_BASS_VOLUME:
+    case GET_CUR_AUDIO_BASS_VOLUME:
+    case GET_AUDIO_TREBLE_VOLUME:
+    case GET_CUR_AUDIO_TREBLE_VOLUME:
+    case GET_AUDIO_SOUND_MODE:
+    case GET_CUR_AUDIO_SOUND_MODE:
+    case GET_AUDIO_EQ_MODE:
+    case GET_CUR_AUDIO_EQ_MODE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// getters and polls that change nothing, everything else may change a setting
+bool TvSettingsCache::isReadOnly(int32_t cmd)
+{
+    switch (cmd) {
+    // tv and source status
+    case GET_TV_STATUS:
+    case GET_LAST_SOURCE_INPUT:
+    case GET_CURRENT_SOURCE_INPUT:
+    case GET_CURRENT_SIGNAL_INFO:
+    case IS_DVI_SIGNAL:
+    case IS_VGA_TIMEING_IN_HDMI:
+    case GET_VIDEO_PATH_STATUS:
+    case GET_SOURCE_CONNECT_STATUS:
+    case GET_SOURCE_INPUT_LIST:
+    case GET_CURRENT_SOURCE_INPUT_VIRTUAL:
+    case GET_HDMI_COLOR_RANGE_MODE:
+    case GET_SETTINGS_MIRROR:
+    case GET_SETTINGS_CHANGED_VERSION:
+    case MISC_GET_TV_API_VERSION:
+    case MISC_GET_DVB_API_VERSION:
+    case HDMIRX_GET_KSV_INFO:
+    case GET_ALL_TV_DEVICES:
+    case GET_HDMI_PORTS:
+    // pq and factory
+    case FACTORY_GETPQMODE_BRIGHTNESS:
+    case FACTORY_GETPQMODE_CONTRAST:
+    case FACTORY_GETPQMODE_SATURATION:
+    case FACTORY_GETPQMODE_HUE:
+    case FACTORY_GETPQMODE_SHARPNESS:
+    case FACTORY_GETTESTPATTERN:
+    case FACTORY_GETDDRSSC:
+    case FACTORY_GETLVDSSSC:
+    case FACTORY_GETNOLINEPARAMS:
+    case FACTORY_GETOVERSCAN:
+    case FACTORY_GET_RGB_PATTERN:
+    case FACTORY_GET_SN:
+    case IS_AUTO_BACKLIGHTING:
+    case GET_AVERAGE_LUMA:
+    case GET_AUTO_BACKLIGHT_DATA:
+    // audio
+    case GET_AUDIO_AVOUT_MUTE_STATUS:
+    case GET_AUDIO_SPDIF_MUTE_STATUS:
+    case GET_AUDIO_SUPPER_BASS_VOLUME:
+    case GET_CUR_AUDIO_SUPPER_BASS_VOLUME:
+    case GET_AUDIO_SUPPER_BASS_SWITCH:
+    case GET_CUR_AUDIO_SUPPER_BASS_SWITCH:
+    case GET_AUDIO_SRS_SURROUND:
+    case GET_CUR_AUDIO_SRS_SURROUND:
+    case GET_AUDIO_SRS_DIALOG_CLARITY:
+    case GET_CUR_AUDIO_SRS_DIALOG_CLARITY:
+    case GET_AUDIO_SRS_TRU_BASS:
+    case GET_CUR_AUDIO_SRS_TRU_BASS:
+    case GET_AUDIO_WALL_EFFECT:
+    case GET_CUR_AUDIO_WALL_EFFECT:
+    case GET_AUDIO_EQ_RANGE:
+    case GET_AUDIO_EQ_BAND_COUNT:
+    case GET_AUDIO_EQ_GAIN:
+    case GET_CUR_EQ_GAIN:
+    case GET_CUR_AUDIO_SPDIF_SWITCH:
+    case GET_CUR_AUDIO_SPDIF_MODE:
+    case GET_AMAUDIO_PRE_MUTE:
+    case GET_AUDIO_VOL_COMP:
+    case GET_USB_AUDIO_DOUBLE_OUTPUT_MODULE_ENABLE:
+    case GET_USB_AUDIO_OUTPUT_MODULE_ENABLE:
+    case GET_AUDIO_VIRTUAL_ENABLE:
+    case GET_AUDIO_VIRTUAL_LEVEL:
+    case DTV_GET_AUDIO_TRACK_NUM:
+    case DTV_GET_AUDIO_TRACK_INFO:
+    case DTV_GET_CURR_AUDIO_TRACK_INDEX:
+    case DTV_GET_AUDIO_CHANNEL_MOD:
+    case DTV_GET_AUDIO_FMT_INFO:
+    case GET_AUDIO_OUTMODE:
+    case GET_AUDIO_STREAM_OUTMODE:
+    case GET_AMAUDIO_VOLUME:
+    case GET_SAVE_AMAUDIO_VOLUME:
+    // ssm
+    case SSM_READ_ONE_BYTE:
+    case SSM_READ_N_BYTES:
+    case SSM_READ_POWER_ON_OFF_CHANNEL:
+    case SSM_READ_SOURCE_INPUT:
+    case SSM_READ_LAST_SOURCE_INPUT:
+    case SSM_READ_SYS_LANGUAGE:
+    case SSM_READ_AGING_MODE:
+    case SSM_READ_PANEL_TYPE:
+    case SSM_READ_MAC_ADDR:
+    case SSM_READ_BAR_CODE:
+    case SSM_READ_POWER_ON_MUSIC_SWITCH:
+    case SSM_READ_POWER_ON_MUSIC_VOL:
+    case SSM_READ_SYS_SLEEP_TIMER:
+    case SSM_READ_INPUT_SRC_PARENTAL_CTL:
+    case SSM_READ_PARENTAL_CTL_SWITCH:
+    case SSM_GET_CUSTOMER_DATA_START:
+    case SSM_GET_CUSTOMER_DATA_LEN:
+    case SSM_READ_STANDBY_MODE:
+    case SSM_READ_LOGO_ON_OFF_FLAG:
+    case SSM_READ_HDMIEQ_MODE:
+    case SSM_READ_HDMIINTERNAL_MODE:
+    case SSM_READ_DISABLE_3D:
+    case SSM_READ_GLOBAL_OGOENABLE:
+    case SSM_READ_LOCAL_DIMING_STATUS:
+    case SSM_READ_NON_STANDARD_STATUS:
+    case SSM_READ_ADB_SWITCH_STATUS:
+    case SSM_READ_SERIAL_CMD_SWITCH_STATUS:
+    case SSM_READ_CA_BUFFER_SIZE:
+    case SSM_GET_ATV_DATA_START:
+    case SSM_GET_ATV_DATA_LEN:
+    case SSM_GET_VPP_DATA_START:
+    case SSM_GET_VPP_DATA_LEN:
+    case SSM_READ_NOISE_GATE_THRESHOLD_STATUS:
+    case SSM_READ_HDCPKEY:
+    case SSM_READ_BLACKOUT_ENABLE:
+    case SSM_READ_HDMI_EDID_VER:
+    case SSM_READ_HDCP_KEY_ENABLE:
+    // atv and dtv
+    case DTV_GET_SUBTITLE_SWITCH:
+    case DTV_GET_SUBTITLE_INDEX:
+    case ATV_GET_CURRENT_PROGRAM_ID:
+    case DTV_GET_CURRENT_PROGRAM_ID:
+    case ATV_GET_MIN_MAX_FREQ:
+    case DTV_GET_SCAN_FREQUENCY_LIST:
+    case DTV_GET_CHANNEL_INFO:
+    case ATV_GET_CHANNEL_INFO:
+    case GET_PROGRAM_LIST:
+    case DTV_GET_SNR:
+    case DTV_GET_BER:
+    case DTV_GET_STRENGTH:
+    case DTV_GET_EPG_UTC_TIME:
+    case DTV_GET_CUR_FREQ:
+    case DTV_GET_EPG_INFO_POINT_IN_TIME:
+    case DTV_GET_EPG_INFO_DURATION:
+    case DTV_GET_BOOKED_EVENT:
+    case DTV_GET_FREQ_BY_PROG_ID:
+    case DTV_GET_VIDEO_FMT_INFO:
+    case GET_PROGRAM_ID:
+    case DTV_GET_SCAN_FREQUENCY_LIST_MODE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool TvSettingsCache::lookup(const Parcel &p, Parcel *r, uint32_t *gen)
+{
+    std::string key((const char *)p.data(), p.dataSize());
+
+    Mutex::Autolock _l(mLock);
+    *gen = mGeneration;
+    if (!mEnabled)
+        return false;
+    std::map<std::string, std::string>::iterator it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        mStats.misses++;
+        return false;
+    }
+    mStats.hits++;
+    r->setDataSize(0);
+    r->write(it->second.data(), it->second.size());
+    r->setDataPosition(0);
+    return true;
+}
+
+void TvSettingsCache::store(const Parcel &p, const Parcel &r, uint32_t gen)
+{
+    Mutex::Autolock _l(mLock);
+    // invalidated while the call was in flight, the reply may be stale
+    if (!mEnabled || gen != mGeneration)
+        return;
+    if (mEntries.size() >= SETTINGS_CACHE_MAX_ENTRIES)
+        mEntries.clear();
+    mEntries[std::string((const char *)p.data(), p.dataSize())] =
+        std::string((const char *)r.data(), r.dataSize());
+}
+
+void TvSettingsCache::invalidate(int32_t cmd)
+{
+    Mutex::Autolock _l(mLock);
+    mGeneration++;
+    mStats.invalidations++;
+    if (cmd < 0) {
+        mEntries.clear();
+        return;
+    }
+    std::map<std::string, std::string>::iterator it = mEntries.begin();
+    while (it != mEntries.end()) {
+        int32_t op;
+        memcpy(&op, it->first.data(), sizeof(op));
+        if (op == cmd)
+            it = mEntries.erase(it);
+        else
+            ++it;
+    }
+}
+
+void TvSettingsCache::setEnabled(bool enabled)
+{
+    Mutex::Autolock _l(mLock);
+    if (mEnabled == enabled)
+        return;
+    mEnabled = enabled;
+    mGeneration++;
+    mEntries.clear();
+}
+
+void TvSettingsCache::getStats(tv_settings_cache_stats_t *stats)
+{
+    Mutex::Autolock _l(mLock);
+    *stats = mStats;
+    stats->entries = mEntries.size();
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#define LOG_TAG "TvSettingsMirror"
+#include <log/log.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cutils/ashmem.h>
+
+#include "include/TvSettingsMirror.h"
+#include "include/tvcmd.h"
+
+// a writer holds the seqlock for a few stores, this only trips on a stuck one
+#define MIRROR_READ_RETRIES 64
+
+static const struct {
+    int32_t cmd;
+    bool hasSource;
+} kMirrorSlots[TV_MIRROR_SLOT_MAX] = {
+    { GET_BRIGHTNESS,           true  },
+    { GET_CONTRAST,             true  },
+    { GET_SATURATION,           true  },
+    { GET_HUE,                  true  },
+    { GET_PQMODE,               true  },
+    { GET_SHARPNESS,            true  },
+    { GET_BACKLIGHT,            true  },
+    { GET_COLOR_TEMPERATURE,    true  },
+    { GET_AUDIO_MASTER_VOLUME,  false },
+    { GET_AUDIO_BALANCE,        false },
+};
+
+TvSettingsMirror::TvSettingsMirror()
+    : mMirror(NULL), mSize(0), mStale(false)
+{
+}
+
+TvSettingsMirror::~TvSettingsMirror()
+{
+    if (mMirror != NULL)
+        munmap((void *)mMirror, mSize);
+    for (size_t i = 0; i < mRetired.size(); i++)
+        munmap((void *)mRetired[i].base, mRetired[i].size);
+}
+
+status_t TvSettingsMirror::attach(const Parcel &reply)
+{
+    // tvservers without the mirror leave the reply empty
+    if (reply.dataSize() == 0)
+        return NAME_NOT_FOUND;
+
+    Mutex::Autolock _l(mLock);
+    if (attached()) {
+        ALOGW("settings mirror already attached");
+        return INVALID_OPERATION;
+    }
+
+    status_t ret = reply.readInt32();
+    if (ret != NO_ERROR)
+        return ret;
+    int fd = reply.readFileDescriptor();
+    int32_t size = reply.readInt32();
+    if (fd < 0 || size < (int32_t)sizeof(tv_settings_mirror_t)) {
+        ALOGE("bad settings mirror, fd %d size %d", fd, size);
+        return BAD_VALUE;
+    }
+
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ALOGE("map settings mirror failed: %s", strerror(errno));
+        return UNKNOWN_ERROR;
+    }
+    const tv_settings_mirror_t *mirror = (const tv_settings_mirror_t *)base;
+    if (mirror->magic != TV_SETTINGS_MIRROR_MAGIC || mirror->version != TV_SETTINGS_MIRROR_VERSION) {
+        ALOGE("settings mirror magic 0x%x version %d not supported", mirror->magic, mirror->version);
+        munmap(base, size);
+        return BAD_VALUE;
+    }
+
+    // the region of a dead tvservice, a reader may still be inside read()
+    if (mMirror != NULL) {
+        Mapping retired = { mMirror, mSize };
+        mRetired.push_back(retired);
+    }
+    mSize = size;
+    __atomic_store_n(&mMirror, mirror, __ATOMIC_RELEASE);
+    __atomic_store_n(&mStale, false, __ATOMIC_RELEASE);
+    return NO_ERROR;
+}
+
+// readers may still be inside read(), the mapping stays until destruction
+void TvSettingsMirror::detach()
+{
+    __atomic_store_n(&mStale, true, __ATOMIC_RELEASE);
+}
+
+bool TvSettingsMirror::attached() const
+{
+    return __atomic_load_n(&mMirror, __ATOMIC_ACQUIRE) != NULL && !__atomic_load_n(&mStale, __ATOMIC_ACQUIRE);
+}
+
+int TvSettingsMirror::slotOf(int32_t cmd, bool *hasSource)
+{
+    for (int i = 0; i < TV_MIRROR_SLOT_MAX; i++) {
+        if (kMirrorSlots[i].cmd == cmd) {
+            if (hasSource != NULL)
+                *hasSource = kMirrorSlots[i].hasSource;
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TvSettingsMirror::read(int slot, int32_t source, int32_t *value) const
+{
+    if (slot < 0 || slot >= TV_MIRROR_SLOT_MAX || !attached())
+        return false;
+
+    const tv_settings_mirror_t *m = __atomic_load_n(&mMirror, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < MIRROR_READ_RETRIES; i++) {
+        uint32_t seq = __atomic_load_n(&m->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+        uint32_t valid = __atomic_load_n(&m->valid, __ATOMIC_RELAXED);
+        int32_t src = __atomic_load_n(&m->source, __ATOMIC_RELAXED);
+        int32_t v = __atomic_load_n(&m->values[slot], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&m->seq, __ATOMIC_RELAXED) != seq)
+            continue;
+
+        if (!(valid & (1u << slot)))
+            return false;
+        if (kMirrorSlots[slot].hasSource && src != source)
+            return false;
+        *value = v;
+        return true;
+    }
+    return false;
+}
+
+bool TvSettingsMirror::lookup(const Parcel &p, Parcel *r) const
+{
+    int32_t cmd, source = -1, value;
+    bool hasSource = false;
+
+    if (p.dataSize() < sizeof(cmd))
+        return false;
+    memcpy(&cmd, p.data(), sizeof(cmd));
+    int slot = slotOf(cmd, &hasSource);
+    if (slot < 0 || p.dataSize() != sizeof(cmd) + (hasSource ? sizeof(source) : 0))
+        return false;
+    if (hasSource)
+        memcpy(&source, p.data() + sizeof(cmd), sizeof(source));
+
+    if (!read(slot, source, &value))
+        return false;
+    r->setDataSize(0);
+    r->writeInt32(value);
+    r->setDataPosition(0);
+    return true;
+}
+
+TvSettingsMirrorPublisher::TvSettingsMirrorPublisher()
+    : mFd(-1), mMirror(NULL)
+{
+}
+
+TvSettingsMirrorPublisher::~TvSettingsMirrorPublisher()
+{
+    if (mMirror != NULL)
+        munmap(mMirror, sizeof(tv_settings_mirror_t));
+    if (mFd >= 0)
+        close(mFd);
+}
+
+status_t TvSettingsMirrorPublisher::init()
+{
+    Mutex::Autolock _l(mLock);
+    if (mMirror != NULL)
+        return NO_ERROR;
+
+    mFd = ashmem_create_region("tv_settings_mirror", sizeof(tv_settings_mirror_t));
+    if (mFd < 0) {
+        ALOGE("create settings mirror failed");
+        return NO_MEMORY;
+    }
+    void *base = mmap(NULL, sizeof(tv_settings_mirror_t), PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (base == MAP_FAILED) {
+        ALOGE("map settings mirror failed: %s", strerror(errno));
+        close(mFd);
+        mFd = -1;
+        return NO_MEMORY;
+    }
+    // clients only get to map it read-only
+    ashmem_set_prot_region(mFd, PROT_READ);
+
+    mMirror = (tv_settings_mirror_t *)base;
+    memset(mMirror, 0, sizeof(*mMirror));
+    mMirror->magic = TV_SETTINGS_MIRROR_MAGIC;
+    mMirror->version = TV_SETTINGS_MIRROR_VERSION;
+    mMirror->source = -1;
+    return NO_ERROR;
+}
+
+status_t TvSettingsMirrorPublisher::writeReply(Parcel *r) const
+{
+    if (mFd < 0)
+        return NO_INIT;
+    r->writeInt32(NO_ERROR);
+    r->writeFileDescriptor(mFd);
+    r->writeInt32(sizeof(tv_settings_mirror_t));
+    return NO_ERROR;
+}
+
+void TvSettingsMirrorPublisher::beginWrite()
+{
+    uint32_t seq = __atomic_load_n(&mMirror->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&mMirror->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void TvSettingsMirrorPublisher::endWrite()
+{
+    uint32_t seq = __atomic_load_n(&mMirror->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&mMirror->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+// the PQ values of the old source no longer apply
+void TvSettingsMirrorPublisher::setSource(int32_t source)
+{
+    Mutex::Autolock _l(mLock);
+    if (mMirror == NULL)
+        return;
+
+    uint32_t valid = 0;
+    for (int i = 0; i < TV_MIRROR_SLOT_MAX; i++) {
+        if (!kMirrorSlots[i].hasSource)
+            valid |= mMirror->valid & (1u << i);
+    }
+    beginWrite();
+    __atomic_store_n(&mMirror->source, source, __ATOMIC_RELAXED);
+    __atomic_store_n(&mMirror->valid, valid, __ATOMIC_RELAXED);
+    endWrite();
+}
+
+void TvSettingsMirrorPublisher::publish(int slot, int32_t value)
+{
+    Mutex::Autolock _l(mLock);
+    if (mMirror == NULL || slot < 0 || slot >= TV_MIRROR_SLOT_MAX)
+        return;
+
+    beginWrite();
+    __atomic_store_n(&mMirror->values[slot], value, __ATOMIC_RELAXED);
+    __atomic_store_n(&mMirror->valid, mMirror->valid | (1u << slot), __ATOMIC_RELAXED);
+    endWrite();
+}
+
+void TvSettingsMirrorPublisher::invalidate(int slot)
+{
+    Mutex::Autolock _l(mLock);
+    if (mMirror == NULL || slot < 0 || slot >= TV_MIRROR_SLOT_MAX)
+        return;
+
+    beginWrite();
+    __atomic_store_n(&mMirror->valid, mMirror->valid & ~(1u << slot), __ATOMIC_RELAXED);
+    endWrite();
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#define LOG_TAG "TvSubtitleRing"
+#include <log/log.h>
+#include <string.h>
+
+#include "include/TvSubtitleRing.h"
+
+#define SUBTITLE_RING_ALIGN(x, a)   (((x) + (a) - 1) & ~((size_t)(a) - 1))
+#define SUBTITLE_BYTES_PER_PIXEL    4
+// the writer republishes latest at most once per frame
+#define SUBTITLE_ACQUIRE_RETRIES    16
+
+static bool rectEmpty(const tv_subtitle_rect_t &r)
+{
+    return r.right <= r.left || r.bottom <= r.top;
+}
+
+static void rectUnion(tv_subtitle_rect_t *dst, const tv_subtitle_rect_t &r)
+{
+    if (rectEmpty(r))
+        return;
+    if (rectEmpty(*dst)) {
+        *dst = r;
+        return;
+    }
+    if (r.left < dst->left) dst->left = r.left;
+    if (r.top < dst->top) dst->top = r.top;
+    if (r.right > dst->right) dst->right = r.right;
+    if (r.bottom > dst->bottom) dst->bottom = r.bottom;
+}
+
+static void rectClip(tv_subtitle_rect_t *r, int width, int height)
+{
+    if (r->left < 0) r->left = 0;
+    if (r->top < 0) r->top = 0;
+    if (r->right > width) r->right = width;
+    if (r->bottom > height) r->bottom = height;
+}
+
+static size_t slotBytes(int width, int height)
+{
+    return SUBTITLE_RING_ALIGN((size_t)width * SUBTITLE_BYTES_PER_PIXEL * height, 64);
+}
+
+size_t tvSubtitleRingSize(int width, int height, int slots)
+{
+    return SUBTITLE_RING_ALIGN(sizeof(tv_subtitle_ring_t), 4096) + slotBytes(width, height) * slots;
+}
+
+TvSubtitleRing::TvSubtitleRing()
+    : mRing(NULL), mLastSeq(0)
+{
+}
+
+sp<TvSubtitleRing> TvSubtitleRing::create(int width, int height, int slots)
+{
+    if (width <= 0 || height <= 0 || slots < TV_SUBTITLE_RING_SLOTS_MIN || slots > TV_SUBTITLE_RING_SLOTS_MAX) {
+        ALOGE("bad subtitle ring %dx%d, %d slots", width, height, slots);
+        return NULL;
+    }
+
+    size_t size = tvSubtitleRingSize(width, height, slots);
+    sp<TvSubtitleRing> ring = new TvSubtitleRing();
+    ring->mHeap = new MemoryHeapBase(size, 0, "tv_subtitle_ring");
+    if (ring->mHeap->getHeapID() < 0) {
+        ALOGE("alloc subtitle ring size %zu fail", size);
+        return NULL;
+    }
+    ring->mMem = new MemoryBase(ring->mHeap, 0, size);
+
+    // fresh ashmem is zeroed, so are the bitmaps
+    tv_subtitle_ring_t *r = (tv_subtitle_ring_t *)ring->mHeap->getBase();
+    r->magic = TV_SUBTITLE_RING_MAGIC;
+    r->version = TV_SUBTITLE_RING_VERSION;
+    r->width = width;
+    r->height = height;
+    r->stride = width * SUBTITLE_BYTES_PER_PIXEL;
+    r->slot_count = slots;
+    r->latest = -1;
+    r->reading = -1;
+    for (int i = 0; i < slots; i++) {
+        r->slots[i].seq = 0;
+        r->slots[i].offset = SUBTITLE_RING_ALIGN(sizeof(tv_subtitle_ring_t), 4096) + slotBytes(width, height) * i;
+    }
+    ring->mRing = r;
+    return ring;
+}
+
+status_t TvSubtitleRing::acquire(tv_subtitle_frame_t *frame)
+{
+    tv_subtitle_ring_t *r = mRing;
+    int slot = -1;
+
+    for (int i = 0; i < SUBTITLE_ACQUIRE_RETRIES; i++) {
+        int latest = __atomic_load_n(&r->latest, __ATOMIC_SEQ_CST);
+        if (latest < 0)
+            return NOT_ENOUGH_DATA;
+        __atomic_store_n(&r->reading, latest, __ATOMIC_SEQ_CST);
+        // still latest after marking it, the writer can no longer pick it
+        if (__atomic_load_n(&r->latest, __ATOMIC_SEQ_CST) == latest) {
+            slot = latest;
+            break;
+        }
+    }
+    if (slot < 0 || slot >= (int)r->slot_count)
+        return WOULD_BLOCK;
+
+    const tv_subtitle_slot_t &s = r->slots[slot];
+    frame->seq = s.seq;
+    frame->pts = s.pts;
+    frame->bitmap = (const uint8_t *)r + s.offset;
+    frame->width = r->width;
+    frame->height = r->height;
+    frame->stride = r->stride;
+    if (s.seq == mLastSeq) {
+        memset(&frame->dirty, 0, sizeof(frame->dirty));
+    } else if (s.seq == mLastSeq + 1) {
+        frame->dirty = s.dirty;
+    } else {
+        // frames were skipped, their dirty areas are unknown
+        frame->dirty.left = 0;
+        frame->dirty.top = 0;
+        frame->dirty.right = r->width;
+        frame->dirty.bottom = r->height;
+    }
+    mLastSeq = s.seq;
+    return NO_ERROR;
+}
+
+void TvSubtitleRing::release()
+{
+    __atomic_store_n(&mRing->reading, -1, __ATOMIC_SEQ_CST);
+}
+
+TvSubtitleRingWriter::TvSubtitleRingWriter()
+    : mBase(NULL), mRing(NULL), mWriting(-1), mSeq(0)
+{
+    memset(mStale, 0, sizeof(mStale));
+}
+
+status_t TvSubtitleRingWriter::attach(void *base, size_t size)
+{
+    tv_subtitle_ring_t *r = (tv_subtitle_ring_t *)base;
+    if (base == NULL || size < sizeof(tv_subtitle_ring_t) || r->magic != TV_SUBTITLE_RING_MAGIC)
+        return BAD_VALUE;
+    if (r->version != TV_SUBTITLE_RING_VERSION || r->slot_count < TV_SUBTITLE_RING_SLOTS_MIN
+        || r->slot_count > TV_SUBTITLE_RING_SLOTS_MAX || r->stride < r->width * SUBTITLE_BYTES_PER_PIXEL
+        || size < tvSubtitleRingSize(r->width, r->height, r->slot_count)) {
+        ALOGE("subtitle ring version %d, %d slots, %dx%d not usable in %zu bytes",
+              r->version, r->slot_count, r->width, r->height, size);
+        return BAD_VALUE;
+    }
+
+    mBase = (uint8_t *)base;
+    mRing = r;
+    mWriting = -1;
+    mSeq = 0;
+    memset(mStale, 0, sizeof(mStale));
+    return NO_ERROR;
+}
+
+void TvSubtitleRingWriter::copyRect(int dst, int src, const tv_subtitle_rect_t &rect)
+{
+    size_t stride = mRing->stride;
+    size_t offset = rect.top * stride + rect.left * SUBTITLE_BYTES_PER_PIXEL;
+    size_t bytes = (rect.right - rect.left) * SUBTITLE_BYTES_PER_PIXEL;
+    uint8_t *to = mBase + mRing->slots[dst].offset + offset;
+    const uint8_t *from = mBase + mRing->slots[src].offset + offset;
+
+    for (int y = rect.top; y < rect.bottom; y++) {
+        memcpy(to, from, bytes);
+        to += stride;
+        from += stride;
+    }
+}
+
+uint8_t *TvSubtitleRingWriter::beginFrame()
+{
+    if (mRing == NULL)
+        return NULL;
+
+    int latest = __atomic_load_n(&mRing->latest, __ATOMIC_SEQ_CST);
+    int reading = __atomic_load_n(&mRing->reading, __ATOMIC_SEQ_CST);
+    mWriting = -1;
+    for (int i = 0; i < (int)mRing->slot_count; i++) {
+        if (i != latest && i != reading) {
+            mWriting = i;
+            break;
+        }
+    }
+    if (mWriting < 0)
+        return NULL;
+
+    // bring the slot up to the newest frame, only what changed since its last use
+    if (latest >= 0 && !rectEmpty(mStale[mWriting]))
+        copyRect(mWriting, latest, mStale[mWriting]);
+    memset(&mStale[mWriting], 0, sizeof(mStale[mWriting]));
+    return mBase + mRing->slots[mWriting].offset;
+}
+
+void TvSubtitleRingWriter::endFrame(const tv_subtitle_rect_t &dirty, int64_t pts)
+{
+    if (mWriting < 0)
+        return;
+
+    tv_subtitle_rect_t rect = dirty;
+    rectClip(&rect, mRing->width, mRing->height);
+    if (rectEmpty(rect))
+        memset(&rect, 0, sizeof(rect));
+
+    tv_subtitle_slot_t *s = &mRing->slots[mWriting];
+    s->pts = pts;
+    s->dirty = rect;
+    s->seq = ++mSeq;
+    __atomic_store_n(&mRing->latest, mWriting, __ATOMIC_SEQ_CST);
+
+    for (int i = 0; i < (int)mRing->slot_count; i++) {
+        if (i != mWriting)
+            rectUnion(&mStale[i], rect);
+    }
+    mWriting = -1;
+}
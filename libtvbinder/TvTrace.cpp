@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#define LOG_TAG "TvTrace"
+#include <log/log.h>
+#include <cutils/trace.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+
+#include "include/TvTrace.h"
+
+typedef struct tv_trace_event_s {
+    std::atomic<bool> ready;        /* set last, the writer skips events still being filled */
+    char phase;                     /* 'B', 'E' or 'C' as in the Chrome trace format */
+    const char *name;
+    int64_t ts;                     /* CLOCK_MONOTONIC, us */
+    int32_t tid;
+    int64_t value;
+} tv_trace_event_t;
+
+static std::mutex sJsonLock;
+static tv_trace_event_t *sEvents = NULL;
+static size_t sCapacity = 0;
+static std::atomic<size_t> sNext(0);
+static std::atomic<bool> sJsonEnabled(false);
+static char *sJsonPath = NULL;
+
+static int32_t traceTid()
+{
+    static thread_local int32_t tid = 0;
+    if (tid == 0)
+        tid = syscall(SYS_gettid);
+    return tid;
+}
+
+static int64_t traceNowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// the buffer is never wrapped, once full new events are dropped
+static void jsonRecord(char phase, const char *name, int64_t value)
+{
+    if (!sJsonEnabled.load(std::memory_order_acquire))
+        return;
+
+    size_t i = sNext.fetch_add(1, std::memory_order_relaxed);
+    if (i >= sCapacity)
+        return;
+
+    tv_trace_event_t *event = &sEvents[i];
+    event->phase = phase;
+    event->name = name;
+    event->ts = traceNowUs();
+    event->tid = traceTid();
+    event->value = value;
+    event->ready.store(true, std::memory_order_release);
+}
+
+void tvTraceBegin(const char *name)
+{
+    atrace_begin(ATRACE_TAG_HAL, name);
+    jsonRecord('B', name, 0);
+}
+
+void tvTraceEnd(const char *name)
+{
+    atrace_end(ATRACE_TAG_HAL);
+    jsonRecord('E', name, 0);
+}
+
+void tvTraceCounter(const char *name, int64_t value)
+{
+    atrace_int64(ATRACE_TAG_HAL, name, value);
+    jsonRecord('C', name, value);
+}
+
+bool tvTraceJsonEnable(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(sJsonLock);
+    if (sEvents != NULL)
+        return true;
+    if (capacity == 0)
+        return false;
+
+    // value-initialized, every ready flag starts false
+    sEvents = new (std::nothrow) tv_trace_event_t[capacity]();
+    if (sEvents == NULL) {
+        ALOGE("alloc %zu trace events fail", capacity);
+        return false;
+    }
+    sCapacity = capacity;
+    sJsonEnabled.store(true, std::memory_order_release);
+    return true;
+}
+
+int tvTraceJsonWrite(int fd)
+{
+    if (!sJsonEnabled.load(std::memory_order_acquire))
+        return 0;
+
+    size_t next = sNext.load(std::memory_order_acquire);
+    size_t count = next < sCapacity ? next : sCapacity;
+    int pid = getpid();
+    int written = 0;
+
+    dprintf(fd, "{\"traceEvents\":[");
+    for (size_t i = 0; i < count; i++) {
+        const tv_trace_event_t &event = sEvents[i];
+        if (!event.ready.load(std::memory_order_acquire))
+            continue;
+        dprintf(fd, "%s\n{\"name\":\"%s\",\"cat\":\"tv\",\"ph\":\"%c\",\"ts\":%" PRId64 ",\"pid\":%d,\"tid\":%d",
+                written > 0 ? "," : "", event.name, event.phase, event.ts, pid, event.tid);
+        if (event.phase == 'C')
+            dprintf(fd, ",\"args\":{\"value\":%" PRId64 "}", event.value);
+        dprintf(fd, "}");
+        written++;
+    }
+    dprintf(fd, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%zu}}\n",
+            next > sCapacity ? next - sCapacity : 0);
+    return written;
+}
+
+static void jsonWriteAtExit()
+{
+    int fd = open(sJsonPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ALOGE("open %s fail: %s", sJsonPath, strerror(errno));
+        return;
+    }
+    tvTraceJsonWrite(fd);
+    close(fd);
+}
+
+__attribute__((constructor)) static void jsonInitFromEnv()
+{
+    const char *path = getenv(TV_TRACE_JSON_ENV);
+    if (path == NULL || path[0] == '\0')
+        return;
+
+    sJsonPath = strdup(path);
+    if (sJsonPath != NULL && tvTraceJsonEnable(TV_TRACE_JSON_DEFAULT_EVENTS))
+        atexit(jsonWriteAtExit);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 periodic video decoder health samples and their statistics
+ */
+
+#define LOG_TAG "TvVdecSampler"
+#include <log/log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "include/TvVdecSampler.h"
+
+namespace android {
+
+TvVdecSampler::TvVdecSampler(const sp<TvServerHidlClient> &client, int vdecId)
+    : Thread(false), mClient(client), mVdecId(vdecId), mPeriod(s2ns(1)), mStopping(false), mHead(0)
+{
+    memset(mSamples, 0, sizeof(mSamples));
+}
+
+// the running thread holds a reference, so it has exited by now
+TvVdecSampler::~TvVdecSampler()
+{
+}
+
+status_t TvVdecSampler::start(nsecs_t period)
+{
+    if (period <= 0)
+        return BAD_VALUE;
+
+    Mutex::Autolock _l(mLock);
+    mPeriod = period;
+    if (isRunning())
+        return NO_ERROR;
+    mStopping = false;
+    return run("TvVdecSampler", PRIORITY_BACKGROUND);
+}
+
+void TvVdecSampler::stop()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        mStopping = true;
+        mCond.signal();
+    }
+    requestExitAndWait();
+}
+
+bool TvVdecSampler::isSampling()
+{
+    return isRunning();
+}
+
+bool TvVdecSampler::threadLoop()
+{
+    BasicVdecState info = mClient->getBasicVdecStatusInfo(mVdecId);
+
+    {
+        Mutex::Autolock _l(mSampleLock);
+        tv_vdec_sample_t *sample = &mSamples[mHead % TV_VDEC_SAMPLES];
+        sample->time = systemTime(SYSTEM_TIME_MONOTONIC);
+        sample->decode_time_cost = info.decode_time_cost;
+        sample->frame_count = info.frame_count;
+        sample->drop_frame_count = info.drop_frame_count;
+        sample->error_frame_count = info.error_frame_count;
+        sample->double_write_mode = info.double_write_mode;
+        mHead++;
+    }
+
+    Mutex::Autolock _l(mLock);
+    if (!mStopping)
+        mCond.waitRelative(mLock, mPeriod);
+    return !mStopping;
+}
+
+// oldest first, returns how many samples are in out
+int TvVdecSampler::snapshot(tv_vdec_sample_t *out, int max)
+{
+    Mutex::Autolock _l(mSampleLock);
+    uint32_t count = std::min<uint32_t>(mHead, TV_VDEC_SAMPLES);
+    count = std::min<uint32_t>(count, max);
+    uint32_t first = mHead - count;
+
+    for (uint32_t i = 0; i < count; i++)
+        out[i] = mSamples[(first + i) % TV_VDEC_SAMPLES];
+    return count;
+}
+
+int TvVdecSampler::getStats(nsecs_t window, tv_vdec_stats_t *stats)
+{
+    tv_vdec_sample_t samples[TV_VDEC_SAMPLES];
+    int count = snapshot(samples, TV_VDEC_SAMPLES);
+
+    memset(stats, 0, sizeof(*stats));
+    if (count == 0)
+        return 0;
+
+    const tv_vdec_sample_t &last = samples[count - 1];
+    int first = count - 1;
+    while (first > 0) {
+        const tv_vdec_sample_t &prev = samples[first - 1];
+        if (window > 0 && last.time - prev.time > window)
+            break;
+        // the decoder was restarted, older counters don't add up
+        if (prev.frame_count > samples[first].frame_count
+            || prev.drop_frame_count > samples[first].drop_frame_count
+            || prev.error_frame_count > samples[first].error_frame_count)
+            break;
+        first--;
+    }
+
+    const tv_vdec_sample_t &begin = samples[first];
+    uint32_t costs[TV_VDEC_SAMPLES];
+    int n = count - first;
+    for (int i = 0; i < n; i++)
+        costs[i] = samples[first + i].decode_time_cost;
+    std::sort(costs, costs + n);
+
+    stats->samples = n;
+    stats->span = last.time - begin.time;
+    stats->decode_time_p50 = costs[(n - 1) * 50 / 100];
+    stats->decode_time_p90 = costs[(n - 1) * 90 / 100];
+    stats->decode_time_p99 = costs[(n - 1) * 99 / 100];
+    stats->decode_time_max = costs[n - 1];
+    stats->double_write_mode = last.double_write_mode;
+
+    uint32_t frames = last.frame_count - begin.frame_count;
+    if (stats->span > 0)
+        stats->fps = frames * 1e9f / stats->span;
+    if (frames > 0) {
+        stats->drop_rate = (float)(last.drop_frame_count - begin.drop_frame_count) / frames;
+        stats->error_rate = (float)(last.error_frame_count - begin.error_frame_count) / frames;
+    }
+    return n;
+}
+
+void TvVdecSampler::dump(int fd)
+{
+    static const struct {
+        const char *name;
+        nsecs_t window;
+    } kWindows[] = {
+        { "10s", s2ns(10) },
+        { "60s", s2ns(60) },
+        { "all", 0 },
+    };
+
+    uint32_t taken;
+    {
+        Mutex::Autolock _l(mSampleLock);
+        taken = mHead;
+    }
+    dprintf(fd, "vdec %d sampler: %s, period %" PRId64 " ms, %u samples taken\n", mVdecId,
+            isRunning() ? "running" : "stopped", ns2ms(mPeriod), taken);
+    for (size_t i = 0; i < sizeof(kWindows) / sizeof(kWindows[0]); i++) {
+        tv_vdec_stats_t stats;
+        if (getStats(kWindows[i].window, &stats) == 0)
+            continue;
+        dprintf(fd, "  %s: %d samples over %" PRId64 " ms, %.2f fps, drop %.2f%%, error %.2f%%, "
+                "decode time p50 %u p90 %u p99 %u max %u, double write %u\n",
+                kWindows[i].name, stats.samples, ns2ms(stats.span), stats.fps,
+                stats.drop_rate * 100, stats.error_rate * 100, stats.decode_time_p50,
+                stats.decode_time_p90, stats.decode_time_p99, stats.decode_time_max,
+                stats.double_write_mode);
+    }
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#define LOG_TAG "TvVideoFrameSession"
+#include <log/log.h>
+
+#include "include/TvVideoFrameSession.h"
+#include "include/TvClient.h"
+
+sp<TvVideoFrameSession> TvVideoFrameSession::create(const sp<TvClient> &client, size_t frameSize, int slots)
+{
+    if (client == NULL || frameSize == 0 || slots < 1 || slots > TV_VIDEO_FRAME_SLOTS_MAX) {
+        ALOGE("bad video frame session, size %zu slots %d", frameSize, slots);
+        return NULL;
+    }
+
+    sp<TvVideoFrameSession> session = new TvVideoFrameSession(client, frameSize);
+    for (int i = 0; i < slots; i++) {
+        slot_t *slot = &session->mSlots[i];
+        slot->heap = new MemoryHeapBase(frameSize, 0, "tv_video_frame");
+        if (slot->heap->getHeapID() < 0) {
+            ALOGE("alloc video frame slot %d size %zu fail", i, frameSize);
+            return NULL;
+        }
+        slot->mem = new MemoryBase(slot->heap, 0, frameSize);
+        session->mSlotCount++;
+    }
+    return session;
+}
+
+TvVideoFrameSession::TvVideoFrameSession(const sp<TvClient> &client, size_t frameSize)
+    : mClient(client), mFrameSize(frameSize), mSlotCount(0), mSeq(0)
+{
+    for (int i = 0; i < TV_VIDEO_FRAME_SLOTS_MAX; i++) {
+        mSlots[i].state = SLOT_FREE;
+        mSlots[i].holds = 0;
+        mSlots[i].seq = 0;
+    }
+}
+
+TvVideoFrameSession::~TvVideoFrameSession()
+{
+}
+
+// a free slot first, else the oldest finished frame nobody holds
+int TvVideoFrameSession::pickSlotLocked()
+{
+    int pick = -1;
+    for (int i = 0; i < mSlotCount; i++) {
+        const slot_t &slot = mSlots[i];
+        if (slot.state == SLOT_FREE)
+            return i;
+        if (slot.state == SLOT_READY && slot.holds == 0 && (pick < 0 || slot.seq < mSlots[pick].seq))
+            pick = i;
+    }
+    return pick;
+}
+
+status_t TvVideoFrameSession::capture(int iSourceMode, int iCapVideoLayerOnly)
+{
+    sp<MemoryBase> mem;
+    int index;
+    {
+        Mutex::Autolock _l(mLock);
+        index = pickSlotLocked();
+        if (index < 0)
+            return WOULD_BLOCK;
+        mSlots[index].state = SLOT_FILLING;
+        mem = mSlots[index].mem;
+    }
+
+    // tvserver writes the slot, the lock stays free for readers meanwhile
+    status_t ret = mClient->createVideoFrame(mem, iSourceMode, iCapVideoLayerOnly);
+
+    Mutex::Autolock _l(mLock);
+    slot_t *slot = &mSlots[index];
+    if (ret != NO_ERROR) {
+        slot->state = SLOT_FREE;
+        slot->seq = 0;
+        return ret;
+    }
+    slot->state = SLOT_READY;
+    slot->seq = ++mSeq;
+    return NO_ERROR;
+}
+
+status_t TvVideoFrameSession::acquire(tv_video_frame_t *frame)
+{
+    Mutex::Autolock _l(mLock);
+    int newest = -1;
+    for (int i = 0; i < mSlotCount; i++) {
+        if (mSlots[i].state == SLOT_READY && (newest < 0 || mSlots[i].seq > mSlots[newest].seq))
+            newest = i;
+    }
+    if (newest < 0)
+        return NOT_ENOUGH_DATA;
+
+    slot_t *slot = &mSlots[newest];
+    slot->holds++;
+    frame->slot = newest;
+    frame->seq = slot->seq;
+    frame->base = slot->heap->getBase();
+    frame->size = mFrameSize;
+    return NO_ERROR;
+}
+
+void TvVideoFrameSession::release(const tv_video_frame_t &frame)
+{
+    Mutex::Autolock _l(mLock);
+    if (frame.slot < 0 || frame.slot >= mSlotCount || mSlots[frame.slot].holds == 0) {
+        ALOGW("release of video frame slot %d not held", frame.slot);
+        return;
+    }
+    mSlots[frame.slot].holds--;
+}
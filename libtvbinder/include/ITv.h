@@ -38,6 +38,13 @@ public:
 
     virtual status_t        processCmd(const Parcel &p, Parcel *r) = 0;
 
+    // start a TV_CMD transaction, the command is then marshalled right after it
+    static void             writeCmdHeader(Parcel *data);
+
+    // send a parcel started with writeCmdHeader(), the reply is received in r
+    // without copying, r is positioned at its first field
+    virtual status_t        transactCmd(const Parcel &data, Parcel *r);
+
     //share mem for subtitle bmp
     virtual status_t        createSubtitle(const sp<IMemory> &share_mem) = 0;
     //share mem for video/hdmi bmp
@@ -22,7 +22,12 @@ class ITvClient: public IInterface {
 public:
     DECLARE_META_INTERFACE(TvClient);
 
+    // p holds only the payload, starting at offset 0
     virtual void notifyCallback(int32_t msgType, const Parcel &p) = 0;
+    // p is the transaction parcel positioned at the first payload field; the
+    // default copies the payload into a parcel of its own for notifyCallback(),
+    // override it to read in place
+    virtual void notifyCallbackInPlace(int32_t msgType, const Parcel &p);
 };
 
 
@@ -12,19 +12,34 @@
 
 #include <utils/Timers.h>
 #include "ITvClient.h"
-#include <binder/MemoryHeapBase.h>
-#include <binder/MemoryBase.h>
 #include <utils/threads.h>
 
+#include "TvPqProfile.h"
+#include "TvSettingsCache.h"
+#include "TvSettingsMirror.h"
+#include "TvVideoFrameSession.h"
+#include "TvSubtitleRing.h"
+
 using namespace android;
 
 class ITvService;
 class ITv;
 
+typedef struct tv_reconnect_stats_s {
+    uint32_t deaths;                /* tvservice deaths seen by this client */
+    uint32_t reconnects;
+    nsecs_t lastLatency;            /* death to connected again */
+    nsecs_t maxLatency;
+} tv_reconnect_stats_t;
+
 // ref-counted object for callbacks
 class TvListener: virtual public RefBase {
 public:
+    // ext holds only the payload, starting at offset 0
     virtual void notify(int32_t msgType, const Parcel &ext) = 0;
+    // ext is read from its current position, the first payload field; the
+    // default copies the payload to offset 0 of its own parcel for notify()
+    virtual void notifyInPlace(int32_t msgType, const Parcel &ext);
 };
 
 class TvClient : public BnTvClient, public IBinder::DeathRecipient {
@@ -43,13 +58,32 @@ public:
     {
         return mStatus;
     }
+    // while tvservice restarts calls fail with DEAD_OBJECT, or wait up to
+    // waitNs for the reconnect first
+    void        setReconnectWait(nsecs_t waitNs);
+    void        getReconnectStats(tv_reconnect_stats_t *stats);
     status_t    processCmd(const Parcel &p, Parcel *r);
+    // data must start with ITv::writeCmdHeader(), cmd is its opcode
+    status_t    transactCmd(const Parcel &data, Parcel *r, int32_t cmd = -1);
+    // all fields in one SET_PQ_PROFILE, falls back to SET_* on older tvservers;
+    // the fallback is not atomic, it stops at the first field tvserver refuses
+    // and returns that result, the fields before it stay applied
+    status_t    applyPqProfile(const tv_pq_profile_t &profile);
     status_t    createSubtitle(const sp<IMemory> &share_mem);
+    // lock-free slots instead of one bitmap, NULL when tvserver can't do it
+    sp<TvSubtitleRing> createSubtitleRing(int width, int height, int slots = TV_SUBTITLE_RING_SLOTS_MIN);
     status_t    createVideoFrame(const sp<IMemory> &share_mem, int iSourceMode, int iCapVideoLayerOnly);
+    // slots capture buffers of frameSize, allocated once and reused
+    sp<TvVideoFrameSession> createVideoFrameSession(size_t frameSize, int slots = 2);
     void        setListener(const sp<TvListener> &listener);
+    void        getSettingsCacheStats(tv_settings_cache_stats_t *stats);
+    // mirrored getter (GET_BRIGHTNESS, GET_AUDIO_BALANCE...), source is
+    // ignored by the audio ones; asks tvserver when the mirror can't answer
+    status_t    getSetting(int32_t cmd, int32_t source, int32_t *value);
 
     // ITvClient interface
     virtual void notifyCallback(int32_t msgType, const Parcel &p);
+    virtual void notifyCallbackInPlace(int32_t msgType, const Parcel &p);
 
     sp<ITv> remote();
 
@@ -58,6 +92,11 @@ private:
     TvClient(const TvClient &);
     TvClient &operator = (const TvClient);
     virtual void binderDied(const wp<IBinder> &who);
+    status_t    getTv(sp<ITv> *tv);
+    void        attachSettingsMirror(const sp<ITv> &tv);
+    void        enableSettingsCache(const sp<ITv> &tv);
+    static int  reconnectThread(void *arg);
+    bool        finishReconnect(const sp<ITvService> &cs);
 
     class DeathNotifier: public IBinder::DeathRecipient {
     public:
@@ -69,19 +108,28 @@ private:
 
     // helper function to obtain tv service handle
     static const sp<ITvService> &getTvService();
+    static sp<ITvService> checkTvService();
 
     sp<ITv>         mTv;
     status_t        mStatus;
+    // guards mTv from the reconnect thread, signalled once it is back
+    Mutex           mTvLock;
+    Condition       mTvCond;
+    bool            mReconnecting;
+    bool            mClosed;
+    nsecs_t         mReconnectWait;
+    nsecs_t         mDiedAt;
+    tv_reconnect_stats_t mReconnectStats;
 
     sp<TvListener>  mListener;
+    bool            mPqProfileUnsupported;
+    TvSettingsCache mSettingsCache;
+    TvSettingsMirror mSettingsMirror;
 
     friend class DeathNotifier;
 
     static  Mutex           mLock;
     static  sp<ITvService>  mTvService;
-
-    sp<MemoryHeapBase>         mBmpMemHeap;
-    sp<MemoryBase>             mBmpMemBase;
 };
 #endif/*_ANDROID_TV_CLIENT_H_*/
 
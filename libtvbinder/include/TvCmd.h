@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_CMD_H
+#define ANDROID_AMLOGIC_TV_CMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <binder/Parcel.h>
+
+#include "ITv.h"
+#include "TvClient.h"
+#include "tvcmd.h"
+
+using namespace android;
+
+/*
+ * Typed TV_CMD stubs.  Every opcode used through TvCmd<> is declared once in
+ * the table below with its reply and argument types, the stub then takes
+ * exactly those arguments and marshals them straight into the transaction
+ * parcel, sized up front.  Opcodes not in the table don't compile through
+ * TvCmd<> and still go through TvClient::processCmd().
+ *
+ *     int32_t brightness;
+ *     TvCmd<GET_BRIGHTNESS>::call(client, &brightness, source);
+ */
+
+template <typename T> struct TvCmdField;
+
+template <> struct TvCmdField<int32_t> {
+    static constexpr size_t kSize = sizeof(int32_t);
+    static void write(Parcel *p, int32_t v) { p->writeInt32(v); }
+    static int32_t read(const Parcel &p) { return p.readInt32(); }
+};
+
+template <> struct TvCmdField<int64_t> {
+    static constexpr size_t kSize = sizeof(int64_t);
+    static void write(Parcel *p, int64_t v) { p->writeInt64(v); }
+    static int64_t read(const Parcel &p) { return p.readInt64(); }
+};
+
+template <> struct TvCmdField<float> {
+    static constexpr size_t kSize = sizeof(float);
+    static void write(Parcel *p, float v) { p->writeFloat(v); }
+    static float read(const Parcel &p) { return p.readFloat(); }
+};
+
+template <typename... T> struct TvCmdArgs {};
+
+template <typename... T> struct TvCmdSize;
+template <> struct TvCmdSize<> {
+    static constexpr size_t value = 0;
+};
+template <typename T, typename... R> struct TvCmdSize<T, R...> {
+    static constexpr size_t value = TvCmdField<T>::kSize + TvCmdSize<R...>::value;
+};
+
+// undefined on purpose, an undeclared opcode is a compile error
+template <int Op> struct TvCmdTraits;
+
+#define TV_CMD_DECLARE(op, reply, ...)                      \
+    template <> struct TvCmdTraits<op> {                    \
+        typedef reply Reply;                                \
+        typedef TvCmdArgs<__VA_ARGS__> Args;                \
+    }
+
+// tv function
+TV_CMD_DECLARE(START_TV, int32_t);
+TV_CMD_DECLARE(STOP_TV, int32_t);
+TV_CMD_DECLARE(GET_CURRENT_SOURCE_INPUT, int32_t);
+TV_CMD_DECLARE(GET_SOURCE_CONNECT_STATUS, int32_t, int32_t /* source */);
+
+// PQ: set(value, source, is_save), get(source), save(value, source)
+#define TV_CMD_DECLARE_PQ(name)                                                         \
+    TV_CMD_DECLARE(SET_##name, int32_t, int32_t, int32_t, int32_t);                     \
+    TV_CMD_DECLARE(GET_##name, int32_t, int32_t);                                       \
+    TV_CMD_DECLARE(SAVE_##name, int32_t, int32_t, int32_t)
+
+TV_CMD_DECLARE_PQ(BRIGHTNESS);
+TV_CMD_DECLARE_PQ(CONTRAST);
+TV_CMD_DECLARE_PQ(SATURATION);
+TV_CMD_DECLARE_PQ(HUE);
+TV_CMD_DECLARE_PQ(PQMODE);
+TV_CMD_DECLARE_PQ(SHARPNESS);
+TV_CMD_DECLARE_PQ(BACKLIGHT);
+TV_CMD_DECLARE_PQ(COLOR_TEMPERATURE);
+
+// audio: set(value), get(), save(value)
+TV_CMD_DECLARE(SET_AUDIO_MASTER_VOLUME, int32_t, int32_t);
+TV_CMD_DECLARE(GET_AUDIO_MASTER_VOLUME, int32_t);
+TV_CMD_DECLARE(SAVE_CUR_AUDIO_MASTER_VOLUME, int32_t, int32_t);
+TV_CMD_DECLARE(SET_AUDIO_BALANCE, int32_t, int32_t);
+TV_CMD_DECLARE(GET_AUDIO_BALANCE, int32_t);
+TV_CMD_DECLARE(SAVE_CUR_AUDIO_BALANCE, int32_t, int32_t);
+
+template <int Op, typename Args = typename TvCmdTraits<Op>::Args> struct TvCmd;
+
+template <int Op, typename... T> struct TvCmd<Op, TvCmdArgs<T...> > {
+    typedef typename TvCmdTraits<Op>::Reply Reply;
+
+    // opcode plus arguments, the interface token is written before
+    static constexpr size_t kSize = sizeof(int32_t) + TvCmdSize<T...>::value;
+
+    static void marshal(Parcel *data, T... args)
+    {
+        ITv::writeCmdHeader(data);
+        data->setDataCapacity(data->dataSize() + kSize);
+        data->writeInt32(Op);
+        int unused[] = { 0, (TvCmdField<T>::write(data, args), 0)... };
+        (void)unused;
+    }
+
+    static status_t call(const sp<TvClient> &client, Reply *reply, T... args)
+    {
+        Parcel data, r;
+        marshal(&data, args...);
+        status_t ret = client->transactCmd(data, &r, Op);
+        if (ret == NO_ERROR && reply != NULL)
+            *reply = TvCmdField<Reply>::read(r);
+        return ret;
+    }
+};
+
+#endif/*ANDROID_AMLOGIC_TV_CMD_H*/
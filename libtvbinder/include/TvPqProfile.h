@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_PQ_PROFILE_H
+#define ANDROID_AMLOGIC_TV_PQ_PROFILE_H
+
+#include <stdint.h>
+
+#define TV_PQ_PROFILE_VERSION 1
+
+// which fields of tv_pq_profile_t are applied
+enum tv_pq_field_e {
+    TV_PQ_FIELD_BRIGHTNESS        = 1 << 0,
+    TV_PQ_FIELD_CONTRAST          = 1 << 1,
+    TV_PQ_FIELD_SATURATION        = 1 << 2,
+    TV_PQ_FIELD_HUE               = 1 << 3,
+    TV_PQ_FIELD_SHARPNESS         = 1 << 4,
+    TV_PQ_FIELD_BACKLIGHT         = 1 << 5,
+    TV_PQ_FIELD_COLOR_TEMPERATURE = 1 << 6,
+};
+
+/*
+ * SET_PQ_PROFILE payload, written in this order after the opcode:
+ * version, source, save, mask, then the seven values.  tvserver applies
+ * the masked fields in a single VPP update and answers with one int32.
+ */
+typedef struct tv_pq_profile_s {
+    int32_t source;
+    int32_t save;               /* also store the values, like SAVE_* */
+    int32_t mask;               /* tv_pq_field_e */
+    int32_t brightness;
+    int32_t contrast;
+    int32_t saturation;
+    int32_t hue;
+    int32_t sharpness;
+    int32_t backlight;
+    int32_t colorTemperature;
+} tv_pq_profile_t;
+
+#endif/*ANDROID_AMLOGIC_TV_PQ_PROFILE_H*/
@@ -26,6 +26,8 @@
 #include <utils/threads.h>
 #include <utils/RefBase.h>
 #include <utils/Mutex.h>
+#include <atomic>
+#include <memory>
 
 #include <vendor/amlogic/hardware/tvserver/1.0/ITvServer.h>
 
@@ -85,6 +87,11 @@ public:
     std::string getSupportInputDevices();
     int getHdmiPorts(int32_t inputSrc);
 
+    // once subscribed, getCurSignalInfo() and getHdmiFormatInfo() read the
+    // values tvserver pushes with SIGNAL_INFO_CHANGED_CALLBACK
+    void subscribeSignalInfo(bool enable);
+    // bumped on every signal or format change seen while subscribed
+    uint32_t getSignalInfoVersion();
     SignalInfo getCurSignalInfo();
     int setMiscCfg(const std::string& key, const std::string& val);
     std::string getMiscCfg(const std::string& key, const std::string& def);
@@ -107,8 +114,20 @@ public:
     int StartTvInPIP( int32_t source_input );
     int StopTvInPIP();
     int IsSupportPIP();
+    void dump(int fd);
 
 private:
+    typedef struct signal_snapshot_s {
+        SignalInfo signal;
+        FormatInfo format;
+    } signal_snapshot_t;
+
+    SignalInfo pollSignalInfo();
+    FormatInfo pollHdmiFormatInfo();
+    std::shared_ptr<const signal_snapshot_t> refreshSignalSnapshot();
+    void storeSignalSnapshot(std::shared_ptr<const signal_snapshot_t> snapshot);
+    void onSignalEvent(const TvHidlParcel &parcel);
+
     class TvServerHidlCallback : public ITvServerCallback {
     public:
         TvServerHidlCallback(TvServerHidlClient *client): tvserverClient(client) {};
@@ -137,6 +156,15 @@ private:
     sp<TvListener> mListener;
     sp<ITvServer> mTvServer;
     sp<TvServerHidlCallback> mTvServerHidlCallback = nullptr;
+
+    // swapped whole with std::atomic_store, readers never lock
+    std::shared_ptr<const signal_snapshot_t> mSignalSnapshot;
+    std::atomic<bool> mSignalSubscribed{false};
+    std::atomic<bool> mSignalPushed{false};
+    std::atomic<uint32_t> mSignalVersion{0};
+    // bumped by every store of mSignalSnapshot, drops polls that raced one
+    std::atomic<uint32_t> mSignalGeneration{0};
+    std::atomic<uint32_t> mReconnects{0};
 };
 
 }//namespace android
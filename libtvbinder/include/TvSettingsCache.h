@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_SETTINGS_CACHE_H
+#define ANDROID_AMLOGIC_TV_SETTINGS_CACHE_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <binder/Parcel.h>
+#include <utils/threads.h>
+
+using namespace android;
+
+// GET_SETTINGS_CHANGED_VERSION a tvserver needs before replies are cached
+#define TV_SETTINGS_CHANGED_VERSION 1
+
+typedef struct tv_settings_cache_stats_s {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;
+    uint32_t entries;
+} tv_settings_cache_stats_t;
+
+/*
+ * Replies of the setting getters, keyed by the raw command (opcode and
+ * arguments).  Other getters and polls leave it alone, anything else sent
+ * by this client may change a setting and drops the whole cache, changes
+ * made by other clients arrive as
+ * SETTINGS_CHANGED_CALLBACK with the getter opcode, or -1 for all.  Without
+ * that callback a change made elsewhere would never be seen, so the cache
+ * stays off until the tvserver reports it sends it.
+ */
+class TvSettingsCache {
+public:
+    TvSettingsCache();
+
+    static int32_t opcodeOf(const Parcel &p);
+    static bool isCacheable(int32_t cmd);
+    static bool isReadOnly(int32_t cmd);
+
+    // on a miss, gen must be handed back to store()
+    bool lookup(const Parcel &p, Parcel *r, uint32_t *gen);
+    void store(const Parcel &p, const Parcel &r, uint32_t gen);
+    void invalidate(int32_t cmd = -1);
+    // turning it off also drops the cached replies
+    void setEnabled(bool enabled);
+    void getStats(tv_settings_cache_stats_t *stats);
+
+private:
+    Mutex mLock;
+    bool mEnabled;
+    uint32_t mGeneration;
+    std::map<std::string, std::string> mEntries;
+    tv_settings_cache_stats_t mStats;
+};
+
+#endif/*ANDROID_AMLOGIC_TV_SETTINGS_CACHE_H*/
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_SETTINGS_MIRROR_H
+#define ANDROID_AMLOGIC_TV_SETTINGS_MIRROR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <binder/Parcel.h>
+#include <utils/threads.h>
+
+using namespace android;
+
+#define TV_SETTINGS_MIRROR_MAGIC    0x544d5352      /* 'TMSR' */
+#define TV_SETTINGS_MIRROR_VERSION  1
+
+// one value per getter, PQ values belong to tv_settings_mirror_t.source
+enum tv_settings_mirror_slot_e {
+    TV_MIRROR_BRIGHTNESS = 0,
+    TV_MIRROR_CONTRAST,
+    TV_MIRROR_SATURATION,
+    TV_MIRROR_HUE,
+    TV_MIRROR_PQMODE,
+    TV_MIRROR_SHARPNESS,
+    TV_MIRROR_BACKLIGHT,
+    TV_MIRROR_COLOR_TEMPERATURE,
+    TV_MIRROR_AUDIO_MASTER_VOLUME,
+    TV_MIRROR_AUDIO_BALANCE,
+    TV_MIRROR_SLOT_MAX,
+};
+
+/*
+ * Layout of the region handed out by GET_SETTINGS_MIRROR, mapped read-only
+ * by every client.  seq is a seqlock: odd while tvserver updates the values,
+ * a reader retries when it changed across its read.  tvserver publishes a
+ * new value before it answers the setter, so a client reading its own write
+ * never sees the old one.
+ */
+typedef struct tv_settings_mirror_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    int32_t  source;                /* source the PQ values belong to */
+    uint32_t valid;                 /* 1 << tv_settings_mirror_slot_e */
+    int32_t  values[TV_MIRROR_SLOT_MAX];
+} tv_settings_mirror_t;
+
+/*
+ * Client side.  Reads never enter the kernel, any miss (not attached, slot
+ * not published, other source, writer too busy) returns false and the
+ * caller goes to tvserver through processCmd.  A reader takes no lock, so
+ * the region of a dead tvservice stays mapped until the mirror is destroyed;
+ * one small region per tvservice restart.
+ */
+class TvSettingsMirror {
+public:
+    TvSettingsMirror();
+    ~TvSettingsMirror();
+
+    // the reply of GET_SETTINGS_MIRROR, fd is only borrowed
+    status_t attach(const Parcel &reply);
+    void detach();
+    bool attached() const;
+
+    // slot of a getter opcode, -1 when not mirrored
+    static int slotOf(int32_t cmd, bool *hasSource);
+
+    bool read(int slot, int32_t source, int32_t *value) const;
+    // raw processCmd() command, on a hit r holds the getter reply
+    bool lookup(const Parcel &p, Parcel *r) const;
+
+private:
+    TvSettingsMirror(const TvSettingsMirror &);
+    TvSettingsMirror &operator = (const TvSettingsMirror &);
+
+    struct Mapping {
+        const void *base;
+        size_t size;
+    };
+
+    // serializes attach() against itself, readers never take it
+    Mutex mLock;
+    const tv_settings_mirror_t *mMirror;
+    size_t mSize;
+    bool mStale;
+    std::vector<Mapping> mRetired;
+};
+
+/*
+ * tvserver side, also what host tests run instead of tvserver: owns the
+ * ashmem region and writes it under the seqlock.
+ */
+class TvSettingsMirrorPublisher {
+public:
+    TvSettingsMirrorPublisher();
+    ~TvSettingsMirrorPublisher();
+
+    status_t init();
+    // GET_SETTINGS_MIRROR reply
+    status_t writeReply(Parcel *r) const;
+
+    void setSource(int32_t source);
+    void publish(int slot, int32_t value);
+    void invalidate(int slot);
+
+private:
+    TvSettingsMirrorPublisher(const TvSettingsMirrorPublisher &);
+    TvSettingsMirrorPublisher &operator = (const TvSettingsMirrorPublisher &);
+
+    void beginWrite();
+    void endWrite();
+
+    Mutex mLock;
+    int mFd;
+    tv_settings_mirror_t *mMirror;
+};
+
+#endif/*ANDROID_AMLOGIC_TV_SETTINGS_MIRROR_H*/
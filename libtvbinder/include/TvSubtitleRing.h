@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_SUBTITLE_RING_H
+#define ANDROID_AMLOGIC_TV_SUBTITLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <binder/MemoryHeapBase.h>
+#include <binder/MemoryBase.h>
+#include <utils/RefBase.h>
+
+using namespace android;
+
+#define TV_SUBTITLE_RING_MAGIC      0x54535247      /* 'TSRG' */
+#define TV_SUBTITLE_RING_VERSION    1
+// the writer skips the newest frame and the one being read, so 3 never block
+#define TV_SUBTITLE_RING_SLOTS_MIN  3
+#define TV_SUBTITLE_RING_SLOTS_MAX  4
+
+// right and bottom are exclusive, empty when right <= left
+typedef struct tv_subtitle_rect_s {
+    int32_t left;
+    int32_t top;
+    int32_t right;
+    int32_t bottom;
+} tv_subtitle_rect_t;
+
+typedef struct tv_subtitle_slot_s {
+    uint32_t seq;                   /* frame number, 0 before the first write */
+    uint32_t offset;                /* bitmap, from the start of the ring */
+    int64_t pts;
+    tv_subtitle_rect_t dirty;       /* changed since frame seq - 1 */
+} tv_subtitle_slot_t;
+
+/*
+ * Start of the createSubtitle() memory in ring mode, followed by the ARGB8888
+ * slot bitmaps.  tvserver writes complete frames into a slot that is neither
+ * latest nor reading and then publishes it through latest, the client marks
+ * the slot it reads in reading.  Both sides only use atomic loads and stores,
+ * no DTV_SUBTITLE_LOCK/UNLOCK.
+ */
+typedef struct tv_subtitle_ring_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                /* bytes per bitmap row */
+    uint32_t slot_count;
+    int32_t  latest;                /* newest published slot, -1 before any */
+    int32_t  reading;               /* slot held by the client, -1 for none */
+    tv_subtitle_slot_t slots[TV_SUBTITLE_RING_SLOTS_MAX];
+} tv_subtitle_ring_t;
+
+typedef struct tv_subtitle_frame_s {
+    uint32_t seq;
+    int64_t pts;
+    const uint8_t *bitmap;
+    int width;
+    int height;
+    int stride;
+    tv_subtitle_rect_t dirty;       /* against the previously acquired frame */
+} tv_subtitle_frame_t;
+
+size_t tvSubtitleRingSize(int width, int height, int slots);
+
+// client side, allocates the ring and reads it
+class TvSubtitleRing : public RefBase {
+public:
+    static sp<TvSubtitleRing> create(int width, int height, int slots);
+
+    // what goes to TvClient::createSubtitle()
+    sp<IMemory> memory() const
+    {
+        return mMem;
+    }
+
+    // newest frame, held until release() or the next acquire()
+    status_t acquire(tv_subtitle_frame_t *frame);
+    void release();
+
+private:
+    TvSubtitleRing();
+
+    sp<MemoryHeapBase> mHeap;
+    sp<MemoryBase> mMem;
+    tv_subtitle_ring_t *mRing;
+    uint32_t mLastSeq;
+};
+
+// tvserver side, draws into the ring handed over by createSubtitle()
+class TvSubtitleRingWriter {
+public:
+    TvSubtitleRingWriter();
+
+    status_t attach(void *base, size_t size);
+    // free slot holding the newest frame, the caller redraws what changed
+    uint8_t *beginFrame();
+    void endFrame(const tv_subtitle_rect_t &dirty, int64_t pts);
+
+private:
+    void copyRect(int dst, int src, const tv_subtitle_rect_t &rect);
+
+    uint8_t *mBase;
+    tv_subtitle_ring_t *mRing;
+    int mWriting;
+    uint32_t mSeq;
+    // published since the slot was last written, copied in by beginFrame()
+    tv_subtitle_rect_t mStale[TV_SUBTITLE_RING_SLOTS_MAX];
+};
+
+#endif/*ANDROID_AMLOGIC_TV_SUBTITLE_RING_H*/
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_TRACE_H
+#define ANDROID_AMLOGIC_TV_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Trace sections and counters of the tv input HAL, under the atrace "hal"
+ * category so they line up with SurfaceFlinger and tvserver in perfetto.
+ * Where no tracing daemon runs (host tests), the same events can go to an
+ * in-memory buffer and be written out as Chrome trace JSON: set
+ * TV_TRACE_JSON=<file> in the environment, or call tvTraceJsonEnable().
+ *
+ * Names are kept by pointer, only pass string literals or __FUNCTION__.
+ */
+#define TV_TRACE_JSON_ENV           "TV_TRACE_JSON"
+#define TV_TRACE_JSON_DEFAULT_EVENTS (64 * 1024)
+
+void tvTraceBegin(const char *name);
+void tvTraceEnd(const char *name);
+void tvTraceCounter(const char *name, int64_t value);
+
+// the buffer is allocated once, later calls keep the first capacity
+bool tvTraceJsonEnable(size_t capacity);
+// writes the events recorded so far, returns how many
+int tvTraceJsonWrite(int fd);
+
+class TvTraceScope {
+public:
+    explicit TvTraceScope(const char *name) : mName(name)
+    {
+        tvTraceBegin(mName);
+    }
+    ~TvTraceScope()
+    {
+        tvTraceEnd(mName);
+    }
+
+private:
+    const char *mName;
+};
+
+#define TV_TRACE_CONCAT_(a, b)          a##b
+#define TV_TRACE_CONCAT(a, b)           TV_TRACE_CONCAT_(a, b)
+#define TV_TRACE_NAME(name)             TvTraceScope TV_TRACE_CONCAT(__tvTrace, __LINE__)(name)
+#define TV_TRACE_CALL()                 TV_TRACE_NAME(__FUNCTION__)
+#define TV_TRACE_COUNTER(name, value)   tvTraceCounter(name, value)
+
+#endif/*ANDROID_AMLOGIC_TV_TRACE_H*/
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *  @par function description:
+ *  - 1 periodic video decoder health samples and their statistics
+ */
+
+#ifndef _ANDROID_TV_VDEC_SAMPLER_H_
+#define _ANDROID_TV_VDEC_SAMPLER_H_
+
+#include <utils/Thread.h>
+#include <utils/Timers.h>
+
+#include "TvServerHidlClient.h"
+
+namespace android {
+
+/* about 4 minutes of history at the default 1 s period */
+#define TV_VDEC_SAMPLES 256
+
+typedef struct tv_vdec_sample_s {
+    nsecs_t time;
+    uint32_t decode_time_cost;
+    uint32_t frame_count;
+    uint32_t drop_frame_count;
+    uint32_t error_frame_count;
+    uint32_t double_write_mode;
+} tv_vdec_sample_t;
+
+typedef struct tv_vdec_stats_s {
+    int samples;
+    nsecs_t span;                   /* first to last sample of the window */
+    float fps;
+    float drop_rate;                /* dropped / decoded frames */
+    float error_rate;               /* error frames / decoded frames */
+    uint32_t decode_time_p50;       /* decode_time_cost percentiles */
+    uint32_t decode_time_p90;
+    uint32_t decode_time_p99;
+    uint32_t decode_time_max;
+    uint32_t double_write_mode;     /* of the last sample */
+} tv_vdec_stats_t;
+
+/*
+ * Polls getBasicVdecStatusInfo() of one decoder into a ring of samples.
+ * The sampler thread writes one sample per period, readers copy the ring
+ * under the same short lock, a few KB once a second is not worth a lock-free
+ * scheme.  Counters that go backwards (decoder restarted) start a new window.
+ */
+class TvVdecSampler : public Thread {
+public:
+    TvVdecSampler(const sp<TvServerHidlClient> &client, int vdecId);
+    ~TvVdecSampler();
+
+    status_t start(nsecs_t period);
+    void stop();
+    bool isSampling();
+
+    // window 0 takes every sample still in the ring
+    int getStats(nsecs_t window, tv_vdec_stats_t *stats);
+    void dump(int fd);
+
+private:
+    virtual bool threadLoop();
+    int snapshot(tv_vdec_sample_t *out, int max);
+
+    sp<TvServerHidlClient> mClient;
+    int mVdecId;
+    nsecs_t mPeriod;
+
+    Mutex mLock;
+    Condition mCond;
+    bool mStopping;
+
+    // never held across the tvserver call
+    Mutex mSampleLock;
+    tv_vdec_sample_t mSamples[TV_VDEC_SAMPLES];
+    uint32_t mHead;                 /* samples written so far */
+};
+
+}
+
+#endif/*_ANDROID_TV_VDEC_SAMPLER_H_*/
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: Header file
+ */
+
+#ifndef ANDROID_AMLOGIC_TV_VIDEO_FRAME_SESSION_H
+#define ANDROID_AMLOGIC_TV_VIDEO_FRAME_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <binder/MemoryHeapBase.h>
+#include <binder/MemoryBase.h>
+#include <utils/RefBase.h>
+#include <utils/threads.h>
+
+using namespace android;
+
+class TvClient;
+
+#define TV_VIDEO_FRAME_SLOTS_MAX 4
+
+typedef struct tv_video_frame_s {
+    int slot;
+    uint32_t seq;                   /* capture order, 0 is never used */
+    const void *base;
+    size_t size;
+} tv_video_frame_t;
+
+/*
+ * A ring of capture buffers allocated once for repeated createVideoFrame()
+ * calls.  With two or more slots tvserver fills one while the reader holds
+ * the last finished one:
+ *
+ *     capture thread:  session->capture(0, 1);
+ *     reader:          session->acquire(&frame); ... session->release(frame);
+ *
+ * A held slot is never filled, capture() returns WOULD_BLOCK when every
+ * slot is held or being filled.
+ */
+class TvVideoFrameSession : public RefBase {
+public:
+    static sp<TvVideoFrameSession> create(const sp<TvClient> &client, size_t frameSize, int slots);
+    virtual ~TvVideoFrameSession();
+
+    status_t capture(int iSourceMode, int iCapVideoLayerOnly);
+    // newest finished frame, NOT_ENOUGH_DATA before the first capture
+    status_t acquire(tv_video_frame_t *frame);
+    void release(const tv_video_frame_t &frame);
+
+    size_t frameSize() const
+    {
+        return mFrameSize;
+    }
+
+private:
+    enum {
+        SLOT_FREE,
+        SLOT_FILLING,
+        SLOT_READY,
+    };
+
+    typedef struct slot_s {
+        sp<MemoryHeapBase> heap;
+        sp<MemoryBase> mem;
+        int state;
+        int holds;
+        uint32_t seq;
+    } slot_t;
+
+    TvVideoFrameSession(const sp<TvClient> &client, size_t frameSize);
+    int pickSlotLocked();
+
+    sp<TvClient> mClient;
+    size_t mFrameSize;
+    Mutex mLock;
+    slot_t mSlots[TV_VIDEO_FRAME_SLOTS_MAX];
+    int mSlotCount;
+    uint32_t mSeq;
+};
+
+#endif/*ANDROID_AMLOGIC_TV_VIDEO_FRAME_SESSION_H*/
@@ -84,6 +84,9 @@ enum tvcmd_e {
     GET_EYE_PROTECTION_MODE = 231,
     SET_GAMMA = 232,
     SET_VIDEO_AXIS = 233,
+    SET_PQ_PROFILE = 234,
+    GET_SETTINGS_MIRROR = 235,
+    GET_SETTINGS_CHANGED_VERSION = 236, // int32, >= 1 once SETTINGS_CHANGED_CALLBACK is sent
     //GETRGBOGO_GAIN_G = 237,
     //GETRGBOGO_GAIN_B = 238,
 
@@ -275,6 +278,8 @@ enum tvcmd_e {
     AUDIO_EVENT_CALLBACK = 550,
     RES_ONPREEMT_CALLBACK = 551,
     QMS_EVENT_CALLBACK = 552,
+    SETTINGS_CHANGED_CALLBACK = 553,    // int32 getter opcode, -1 for all
+    SIGNAL_INFO_CHANGED_CALLBACK = 554, // SignalInfo then FormatInfo fields, 8 int32
     // CALLBACK END
 
     // SSM
@@ -459,6 +464,7 @@ enum tvcmd_e {
     DTV_STOP_SUBTITLE = 1385,
     DTV_GET_SUBTITLE_INDEX = 1386,
     DTV_SET_SUBTITLE_INDEX = 1387,
+    DTV_SUBTITLE_RING_VERSION = 1388,
     ATV_GET_CURRENT_PROGRAM_ID = 1389,
     DTV_GET_CURRENT_PROGRAM_ID = 1390,
     ATV_SAVE_PROGRAM_ID = 1391,
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#include <stdint.h>
+
+#include <gtest/gtest.h>
+
+#include "include/TvSettingsCache.h"
+#include "include/tvcmd.h"
+
+namespace {
+
+Parcel command(int32_t cmd, int32_t arg)
+{
+    Parcel p;
+    p.writeInt32(cmd);
+    p.writeInt32(arg);
+    return p;
+}
+
+Parcel reply(int32_t value)
+{
+    Parcel r;
+    r.writeInt32(value);
+    return r;
+}
+
+// a getter sent to the tvserver after a miss, as TvClient::processCmd does
+void fill(TvSettingsCache *cache, const Parcel &p, int32_t value)
+{
+    Parcel r;
+    uint32_t gen;
+    ASSERT_FALSE(cache->lookup(p, &r, &gen));
+    cache->store(p, reply(value), gen);
+}
+
+bool cached(TvSettingsCache *cache, const Parcel &p, int32_t *value)
+{
+    Parcel r;
+    uint32_t gen;
+    if (!cache->lookup(p, &r, &gen))
+        return false;
+    *value = r.readInt32();
+    return true;
+}
+
+}  // namespace
+
+TEST(TvSettingsCache, OffUntilEnabled)
+{
+    TvSettingsCache cache;
+    Parcel p = command(GET_BRIGHTNESS, 0);
+    int32_t value;
+
+    fill(&cache, p, 50);
+    EXPECT_FALSE(cached(&cache, p, &value));
+}
+
+TEST(TvSettingsCache, HitAndMiss)
+{
+    TvSettingsCache cache;
+    cache.setEnabled(true);
+    Parcel brightness = command(GET_BRIGHTNESS, 0);
+    int32_t value = 0;
+
+    fill(&cache, brightness, 50);
+    ASSERT_TRUE(cached(&cache, brightness, &value));
+    EXPECT_EQ(50, value);
+
+    // other arguments or another getter are separate entries
+    EXPECT_FALSE(cached(&cache, command(GET_BRIGHTNESS, 1), &value));
+    EXPECT_FALSE(cached(&cache, command(GET_CONTRAST, 0), &value));
+
+    tv_settings_cache_stats_t stats;
+    cache.getStats(&stats);
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(3u, stats.misses);
+    EXPECT_EQ(1u, stats.entries);
+}
+
+// a reply that raced an invalidation must not be cached
+TEST(TvSettingsCache, StoreAfterInvalidateIsDropped)
+{
+    TvSettingsCache cache;
+    cache.setEnabled(true);
+    Parcel p = command(GET_BRIGHTNESS, 0);
+    Parcel r;
+    uint32_t gen;
+    int32_t value;
+
+    ASSERT_FALSE(cache.lookup(p, &r, &gen));
+    cache.invalidate(GET_BRIGHTNESS);
+    cache.store(p, reply(50), gen);
+    EXPECT_FALSE(cached(&cache, p, &value));
+
+    // the same for a change of an unrelated getter, the generation is global
+    ASSERT_FALSE(cache.lookup(p, &r, &gen));
+    cache.invalidate(GET_CONTRAST);
+    cache.store(p, reply(50), gen);
+    EXPECT_FALSE(cached(&cache, p, &value));
+
+    // and for disabling in between
+    ASSERT_FALSE(cache.lookup(p, &r, &gen));
+    cache.setEnabled(false);
+    cache.setEnabled(true);
+    cache.store(p, reply(50), gen);
+    EXPECT_FALSE(cached(&cache, p, &value));
+}
+
+TEST(TvSettingsCache, InvalidateOneGetter)
+{
+    TvSettingsCache cache;
+    cache.setEnabled(true);
+    Parcel brightness0 = command(GET_BRIGHTNESS, 0);
+    Parcel brightness1 = command(GET_BRIGHTNESS, 1);
+    Parcel contrast = command(GET_CONTRAST, 0);
+    int32_t value = 0;
+
+    fill(&cache, brightness0, 10);
+    fill(&cache, brightness1, 11);
+    fill(&cache, contrast, 20);
+
+    cache.invalidate(GET_BRIGHTNESS);
+    EXPECT_FALSE(cached(&cache, brightness0, &value));
+    EXPECT_FALSE(cached(&cache, brightness1, &value));
+    ASSERT_TRUE(cached(&cache, contrast, &value));
+    EXPECT_EQ(20, value);
+
+    cache.invalidate();
+    EXPECT_FALSE(cached(&cache, contrast, &value));
+}
+
+TEST(TvSettingsCache, DisableDropsEntries)
+{
+    TvSettingsCache cache;
+    cache.setEnabled(true);
+    Parcel p = command(GET_BRIGHTNESS, 0);
+    int32_t value;
+
+    fill(&cache, p, 50);
+    cache.setEnabled(false);
+    EXPECT_FALSE(cached(&cache, p, &value));
+
+    tv_settings_cache_stats_t stats;
+    cache.getStats(&stats);
+    EXPECT_EQ(0u, stats.entries);
+
+    cache.setEnabled(true);
+    EXPECT_FALSE(cached(&cache, p, &value));
+}
+
+TEST(TvSettingsCache, Classification)
+{
+    // polls and uncached getters must not drop the cache
+    EXPECT_TRUE(TvSettingsCache::isReadOnly(GET_CURRENT_SOURCE_INPUT));
+    EXPECT_TRUE(TvSettingsCache::isReadOnly(GET_SOURCE_CONNECT_STATUS));
+    EXPECT_TRUE(TvSettingsCache::isReadOnly(SSM_READ_HDMI_EDID_VER));
+
+    EXPECT_FALSE(TvSettingsCache::isReadOnly(SET_BRIGHTNESS));
+    EXPECT_FALSE(TvSettingsCache::isReadOnly(SAVE_BRIGHTNESS));
+    EXPECT_FALSE(TvSettingsCache::isReadOnly(FACTORY_RESETPQMODE));
+    EXPECT_FALSE(TvSettingsCache::isReadOnly(SET_SOURCE_INPUT));
+
+    EXPECT_TRUE(TvSettingsCache::isCacheable(GET_BRIGHTNESS));
+    EXPECT_FALSE(TvSettingsCache::isReadOnly(GET_BRIGHTNESS));
+}
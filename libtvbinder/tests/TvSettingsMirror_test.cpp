@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "include/TvSettingsMirror.h"
+#include "include/tvcmd.h"
+
+namespace {
+
+const int32_t kWriterRounds = 200000;
+const int kReattachRounds = 200;
+
+// what TvClient::attachSettingsMirror does with the GET_SETTINGS_MIRROR reply
+status_t attachTo(TvSettingsMirror *mirror, const TvSettingsMirrorPublisher &publisher)
+{
+    Parcel r;
+    status_t ret = publisher.writeReply(&r);
+    if (ret != NO_ERROR)
+        return ret;
+    r.setDataPosition(0);
+    return mirror->attach(r);
+}
+
+// mappings of mirror regions in this process, the publishers' ones included
+int mirrorMappings()
+{
+    FILE *maps = fopen("/proc/self/maps", "r");
+    if (maps == NULL)
+        return -1;
+    char line[512];
+    int count = 0;
+    while (fgets(line, sizeof(line), maps) != NULL) {
+        if (strstr(line, "tv_settings_mirror") != NULL)
+            count++;
+    }
+    fclose(maps);
+    return count;
+}
+
+}  // namespace
+
+TEST(TvSettingsMirror, MissesUntilAttached)
+{
+    TvSettingsMirror mirror;
+    int32_t value;
+
+    EXPECT_FALSE(mirror.attached());
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, 0, &value));
+
+    // a tvserver without the mirror answers with an empty reply
+    Parcel empty;
+    EXPECT_EQ(NAME_NOT_FOUND, mirror.attach(empty));
+    EXPECT_FALSE(mirror.attached());
+}
+
+TEST(TvSettingsMirror, SourceMismatch)
+{
+    TvSettingsMirrorPublisher publisher;
+    ASSERT_EQ(NO_ERROR, publisher.init());
+    TvSettingsMirror mirror;
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, publisher));
+    int32_t value = 0;
+
+    // nothing published yet
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, -1, &value));
+
+    publisher.setSource(3);
+    publisher.publish(TV_MIRROR_BRIGHTNESS, 50);
+    publisher.publish(TV_MIRROR_AUDIO_MASTER_VOLUME, 20);
+    ASSERT_TRUE(mirror.read(TV_MIRROR_BRIGHTNESS, 3, &value));
+    EXPECT_EQ(50, value);
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, 4, &value));
+
+    // the audio values don't belong to a source
+    ASSERT_TRUE(mirror.read(TV_MIRROR_AUDIO_MASTER_VOLUME, 4, &value));
+    EXPECT_EQ(20, value);
+
+    // a source switch drops the PQ values only
+    publisher.setSource(4);
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, 3, &value));
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, 4, &value));
+    EXPECT_TRUE(mirror.read(TV_MIRROR_AUDIO_MASTER_VOLUME, 4, &value));
+
+    // the raw processCmd() path
+    publisher.publish(TV_MIRROR_BRIGHTNESS, 60);
+    Parcel p, r;
+    p.writeInt32(GET_BRIGHTNESS);
+    p.writeInt32(4);
+    ASSERT_TRUE(mirror.lookup(p, &r));
+    EXPECT_EQ(60, r.readInt32());
+
+    Parcel other;
+    other.writeInt32(GET_BRIGHTNESS);
+    other.writeInt32(3);
+    EXPECT_FALSE(mirror.lookup(other, &r));
+}
+
+TEST(TvSettingsMirror, InvalidateSlot)
+{
+    TvSettingsMirrorPublisher publisher;
+    ASSERT_EQ(NO_ERROR, publisher.init());
+    TvSettingsMirror mirror;
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, publisher));
+    int32_t value = 0;
+
+    publisher.setSource(1);
+    publisher.publish(TV_MIRROR_BRIGHTNESS, 50);
+    publisher.publish(TV_MIRROR_CONTRAST, 40);
+
+    publisher.invalidate(TV_MIRROR_BRIGHTNESS);
+    EXPECT_FALSE(mirror.read(TV_MIRROR_BRIGHTNESS, 1, &value));
+    ASSERT_TRUE(mirror.read(TV_MIRROR_CONTRAST, 1, &value));
+    EXPECT_EQ(40, value);
+
+    publisher.publish(TV_MIRROR_BRIGHTNESS, 55);
+    ASSERT_TRUE(mirror.read(TV_MIRROR_BRIGHTNESS, 1, &value));
+    EXPECT_EQ(55, value);
+}
+
+TEST(TvSettingsMirror, DetachAndReattach)
+{
+    std::unique_ptr<TvSettingsMirrorPublisher> first(new TvSettingsMirrorPublisher());
+    ASSERT_EQ(NO_ERROR, first->init());
+    TvSettingsMirror mirror;
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, *first));
+    int32_t value = 0;
+
+    first->publish(TV_MIRROR_AUDIO_BALANCE, 1);
+    EXPECT_EQ(INVALID_OPERATION, attachTo(&mirror, *first));
+
+    // tvservice died, its values must not be served any more
+    mirror.detach();
+    first.reset();
+    EXPECT_FALSE(mirror.attached());
+    EXPECT_FALSE(mirror.read(TV_MIRROR_AUDIO_BALANCE, -1, &value));
+
+    TvSettingsMirrorPublisher second;
+    ASSERT_EQ(NO_ERROR, second.init());
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, second));
+    EXPECT_TRUE(mirror.attached());
+    EXPECT_FALSE(mirror.read(TV_MIRROR_AUDIO_BALANCE, -1, &value));
+    second.publish(TV_MIRROR_AUDIO_BALANCE, 2);
+    ASSERT_TRUE(mirror.read(TV_MIRROR_AUDIO_BALANCE, -1, &value));
+    EXPECT_EQ(2, value);
+}
+
+/*
+ * The writer moves to source n and then publishes n as its brightness, the
+ * volume always carries the round too.  A read that mixes two updates would
+ * return a brightness of another source, or a volume that went back.
+ */
+TEST(TvSettingsMirror, ConcurrentWriter)
+{
+    TvSettingsMirrorPublisher publisher;
+    ASSERT_EQ(NO_ERROR, publisher.init());
+    TvSettingsMirror mirror;
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, publisher));
+    std::atomic<int32_t> round(0);
+
+    std::thread writer([&]() {
+        for (int32_t n = 1; n <= kWriterRounds; n++) {
+            publisher.setSource(n);
+            round.store(n, std::memory_order_release);
+            publisher.publish(TV_MIRROR_BRIGHTNESS, n);
+            publisher.publish(TV_MIRROR_AUDIO_MASTER_VOLUME, n);
+        }
+    });
+
+    uint32_t hits = 0, wrongSource = 0, backwards = 0;
+    int32_t lastVolume = 0;
+    while (round.load(std::memory_order_acquire) < kWriterRounds) {
+        int32_t n = round.load(std::memory_order_acquire);
+        int32_t value;
+        // n + 1 catches the writer in the middle of its next source switch
+        for (int32_t source = n; source <= n + 1; source++) {
+            if (mirror.read(TV_MIRROR_BRIGHTNESS, source, &value)) {
+                hits++;
+                wrongSource += value != source;
+            }
+        }
+        if (mirror.read(TV_MIRROR_AUDIO_MASTER_VOLUME, -1, &value)) {
+            backwards += value < lastVolume;
+            lastVolume = value;
+        }
+    }
+    writer.join();
+
+    EXPECT_EQ(0u, wrongSource) << hits << " brightness hits";
+    EXPECT_EQ(0u, backwards);
+    int32_t value = 0;
+    ASSERT_TRUE(mirror.read(TV_MIRROR_BRIGHTNESS, kWriterRounds, &value));
+    EXPECT_EQ(kWriterRounds, value);
+}
+
+// readers keep going through tvservice restarts, the old regions stay mapped
+TEST(TvSettingsMirror, ReattachWhileReading)
+{
+    TvSettingsMirror mirror;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> reads(0);
+
+    std::unique_ptr<TvSettingsMirrorPublisher> publisher(new TvSettingsMirrorPublisher());
+    ASSERT_EQ(NO_ERROR, publisher->init());
+    publisher->publish(TV_MIRROR_AUDIO_BALANCE, 0);
+    ASSERT_EQ(NO_ERROR, attachTo(&mirror, *publisher));
+
+    std::thread reader([&]() {
+        while (!done) {
+            int32_t value;
+            mirror.read(TV_MIRROR_AUDIO_BALANCE, -1, &value);
+            reads++;
+        }
+    });
+
+    for (int i = 1; i <= kReattachRounds; i++) {
+        mirror.detach();
+        publisher.reset(new TvSettingsMirrorPublisher());
+        ASSERT_EQ(NO_ERROR, publisher->init());
+        publisher->publish(TV_MIRROR_AUDIO_BALANCE, i);
+        ASSERT_EQ(NO_ERROR, attachTo(&mirror, *publisher));
+
+        int32_t value = -1;
+        ASSERT_TRUE(mirror.read(TV_MIRROR_AUDIO_BALANCE, -1, &value));
+        EXPECT_EQ(i, value);
+    }
+    done = true;
+    reader.join();
+    EXPECT_GT(reads.load(), 0u);
+
+    // with the publisher gone, the current region and every retired one
+    // are still mapped
+    publisher.reset();
+    EXPECT_EQ(kReattachRounds + 1, mirrorMappings());
+}
+
+// the mirror unmaps the retired regions with itself
+TEST(TvSettingsMirror, RetiredUnmappedOnDestruction)
+{
+    int before = mirrorMappings();
+    ASSERT_GE(before, 0);
+    {
+        TvSettingsMirror mirror;
+        for (int i = 0; i < 3; i++) {
+            TvSettingsMirrorPublisher publisher;
+            ASSERT_EQ(NO_ERROR, publisher.init());
+            mirror.detach();
+            ASSERT_EQ(NO_ERROR, attachTo(&mirror, publisher));
+        }
+        EXPECT_EQ(before + 3, mirrorMappings());
+    }
+    EXPECT_EQ(before, mirrorMappings());
+}
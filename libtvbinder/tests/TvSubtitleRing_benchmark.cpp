@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "include/TvSubtitleRing.h"
+
+namespace {
+
+const int kWidth = 1920;
+const int kHeight = 1080;
+
+// a two line caption at the bottom, what most subtitle frames change
+tv_subtitle_rect_t captionRect(int64_t n)
+{
+    tv_subtitle_rect_t r;
+    r.left = 320 + (n % 8) * 16;
+    r.top = 900;
+    r.right = 1600 - (n % 8) * 16;
+    r.bottom = 1000;
+    return r;
+}
+
+void drawRect(uint8_t *bitmap, int stride, const tv_subtitle_rect_t &r, uint32_t value)
+{
+    for (int y = r.top; y < r.bottom; y++) {
+        uint32_t *row = (uint32_t *)(bitmap + y * stride);
+        for (int x = r.left; x < r.right; x++)
+            row[x] = value;
+    }
+}
+
+}  // namespace
+
+// one frame through the ring: redraw the caption, publish, acquire on the client
+static void BM_SubtitleRingFrame(benchmark::State &state)
+{
+    sp<TvSubtitleRing> ring = TvSubtitleRing::create(kWidth, kHeight, state.range(0));
+    TvSubtitleRingWriter writer;
+    writer.attach(ring->memory()->unsecurePointer(), ring->memory()->size());
+    int64_t n = 0;
+
+    for (auto _ : state) {
+        uint8_t *bitmap = writer.beginFrame();
+        tv_subtitle_rect_t r = captionRect(++n);
+        drawRect(bitmap, kWidth * 4, r, (uint32_t)n);
+        writer.endFrame(r, n);
+
+        tv_subtitle_frame_t frame;
+        ring->acquire(&frame);
+        benchmark::DoNotOptimize(frame.bitmap);
+        ring->release();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SubtitleRingFrame)->Arg(TV_SUBTITLE_RING_SLOTS_MIN)->Arg(TV_SUBTITLE_RING_SLOTS_MAX);
+
+// the single bitmap path: redraw, then the client copies the whole bitmap under the lock
+static void BM_SubtitleBitmapCopy(benchmark::State &state)
+{
+    std::vector<uint8_t> shared((size_t)kWidth * 4 * kHeight);
+    std::vector<uint8_t> client(shared.size());
+    int64_t n = 0;
+
+    for (auto _ : state) {
+        tv_subtitle_rect_t r = captionRect(++n);
+        drawRect(shared.data(), kWidth * 4, r, (uint32_t)n);
+        memcpy(client.data(), shared.data(), shared.size());
+        benchmark::DoNotOptimize(client.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SubtitleBitmapCopy);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2026 Amlogic, Inc. All rights reserved.
+ *
+ * This source code is subject to the terms and conditions defined in the
+ * file 'LICENSE' which is part of this source code package.
+ *
+ * Description: C++ file
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "include/TvSubtitleRing.h"
+
+namespace {
+
+const int kWidth = 64;
+const int kHeight = 32;
+const uint32_t kFrames = 3000;
+
+typedef std::vector<uint32_t> Image;
+
+bool sameRect(const tv_subtitle_rect_t &a, const tv_subtitle_rect_t &b)
+{
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+bool rectEmpty(const tv_subtitle_rect_t &r)
+{
+    return r.right <= r.left || r.bottom <= r.top;
+}
+
+bool inRect(const tv_subtitle_rect_t &r, int x, int y)
+{
+    return x >= r.left && x < r.right && y >= r.top && y < r.bottom;
+}
+
+/*
+ * A synthetic subtitle stream: frame n fills one rect with the value n, on
+ * top of frame n - 1.  Frame 0 is the zeroed ring.  expected[n] is the full
+ * image a reader has to see for frame n.
+ */
+struct SyntheticStream {
+    std::vector<tv_subtitle_rect_t> rects;
+    std::vector<Image> expected;
+
+    explicit SyntheticStream(uint32_t frames)
+        : rects(frames + 1), expected(frames + 1)
+    {
+        uint32_t state = 12345;
+        expected[0].assign(kWidth * kHeight, 0);
+        memset(&rects[0], 0, sizeof(rects[0]));
+        for (uint32_t n = 1; n <= frames; n++) {
+            state = state * 1103515245 + 12345;
+            tv_subtitle_rect_t &r = rects[n];
+            r.left = (state >> 8) % kWidth;
+            r.top = (state >> 16) % kHeight;
+            r.right = r.left + 1 + (state >> 4) % (kWidth - r.left);
+            r.bottom = r.top + 1 + (state >> 20) % (kHeight - r.top);
+
+            expected[n] = expected[n - 1];
+            for (int y = r.top; y < r.bottom; y++) {
+                for (int x = r.left; x < r.right; x++)
+                    expected[n][y * kWidth + x] = n;
+            }
+        }
+    }
+};
+
+// draws only the dirty rect, the ring brings the rest of the slot up to date
+void drawFrame(uint8_t *bitmap, int stride, const tv_subtitle_rect_t &r, uint32_t value)
+{
+    for (int y = r.top; y < r.bottom; y++) {
+        uint32_t *row = (uint32_t *)(bitmap + y * stride);
+        for (int x = r.left; x < r.right; x++)
+            row[x] = value;
+    }
+}
+
+struct RingPair {
+    sp<TvSubtitleRing> ring;
+    TvSubtitleRingWriter writer;
+
+    explicit RingPair(int slots)
+    {
+        ring = TvSubtitleRing::create(kWidth, kHeight, slots);
+        if (ring != NULL)
+            writer.attach(ring->memory()->unsecurePointer(), ring->memory()->size());
+    }
+};
+
+}  // namespace
+
+TEST(TvSubtitleRing, RejectsBadGeometry)
+{
+    EXPECT_EQ(nullptr, TvSubtitleRing::create(0, kHeight, TV_SUBTITLE_RING_SLOTS_MIN).get());
+    EXPECT_EQ(nullptr, TvSubtitleRing::create(kWidth, kHeight, TV_SUBTITLE_RING_SLOTS_MIN - 1).get());
+    EXPECT_EQ(nullptr, TvSubtitleRing::create(kWidth, kHeight, TV_SUBTITLE_RING_SLOTS_MAX + 1).get());
+
+    uint32_t junk[64] = { 0 };
+    TvSubtitleRingWriter writer;
+    EXPECT_EQ(BAD_VALUE, writer.attach(junk, sizeof(junk)));
+    EXPECT_EQ(nullptr, writer.beginFrame());
+}
+
+TEST(TvSubtitleRing, EmptyUntilFirstFrame)
+{
+    RingPair pair(TV_SUBTITLE_RING_SLOTS_MIN);
+    ASSERT_NE(nullptr, pair.ring.get());
+
+    tv_subtitle_frame_t frame;
+    EXPECT_EQ(NOT_ENOUGH_DATA, pair.ring->acquire(&frame));
+}
+
+// the writer must never pick the slot the reader holds or the newest one
+TEST(TvSubtitleRing, WriterSkipsHeldSlots)
+{
+    for (int slots = TV_SUBTITLE_RING_SLOTS_MIN; slots <= TV_SUBTITLE_RING_SLOTS_MAX; slots++) {
+        RingPair pair(slots);
+        ASSERT_NE(nullptr, pair.ring.get());
+        const tv_subtitle_ring_t *r = (const tv_subtitle_ring_t *)pair.ring->memory()->unsecurePointer();
+        tv_subtitle_rect_t all = { 0, 0, kWidth, kHeight };
+        tv_subtitle_frame_t frame;
+
+        for (int n = 1; n <= 20; n++) {
+            ASSERT_NE(nullptr, pair.writer.beginFrame());
+            pair.writer.endFrame(all, n);
+            ASSERT_EQ(NO_ERROR, pair.ring->acquire(&frame));
+            const uint8_t *held = frame.bitmap;
+
+            for (int k = 0; k < 3; k++) {
+                uint8_t *bitmap = pair.writer.beginFrame();
+                ASSERT_NE(nullptr, bitmap);
+                EXPECT_NE(held, bitmap);
+                EXPECT_NE((const uint8_t *)r + r->slots[r->latest].offset, bitmap);
+                pair.writer.endFrame(all, n);
+            }
+            pair.ring->release();
+        }
+    }
+}
+
+// every acquired frame matches the stream exactly and its dirty rect covers
+// every pixel that differs from the previously acquired frame
+TEST(TvSubtitleRing, ConcurrentReaderSeesWholeFrames)
+{
+    SyntheticStream stream(kFrames);
+
+    for (int slots = TV_SUBTITLE_RING_SLOTS_MIN; slots <= TV_SUBTITLE_RING_SLOTS_MAX; slots++) {
+        RingPair pair(slots);
+        ASSERT_NE(nullptr, pair.ring.get());
+        std::atomic<bool> done(false);
+
+        std::thread writer([&]() {
+            for (uint32_t n = 1; n <= kFrames; n++) {
+                uint8_t *bitmap;
+                while ((bitmap = pair.writer.beginFrame()) == NULL)
+                    std::this_thread::yield();
+                drawFrame(bitmap, kWidth * 4, stream.rects[n], n);
+                pair.writer.endFrame(stream.rects[n], n);
+            }
+            done = true;
+        });
+
+        uint32_t last = 0;
+        uint32_t acquired = 0, torn = 0, badDirty = 0, badPts = 0;
+        while (last < kFrames) {
+            bool finished = done;
+            tv_subtitle_frame_t frame;
+            status_t ret = pair.ring->acquire(&frame);
+            if (ret != NO_ERROR) {
+                std::this_thread::yield();
+                continue;
+            }
+            acquired++;
+            ASSERT_GE(frame.seq, last);
+            ASSERT_LE(frame.seq, kFrames);
+            ASSERT_EQ(kWidth * 4, frame.stride);
+
+            const Image &want = stream.expected[frame.seq];
+            const Image &before = stream.expected[last];
+            bool frameTorn = false, frameBadDirty = false;
+            for (int y = 0; y < kHeight; y++) {
+                const uint32_t *row = (const uint32_t *)(frame.bitmap + y * frame.stride);
+                for (int x = 0; x < kWidth; x++) {
+                    if (row[x] != want[y * kWidth + x])
+                        frameTorn = true;
+                    if (want[y * kWidth + x] != before[y * kWidth + x] && !inRect(frame.dirty, x, y))
+                        frameBadDirty = true;
+                }
+            }
+            torn += frameTorn;
+            badDirty += frameBadDirty;
+            badPts += frame.pts != (int64_t)frame.seq;
+
+            // consecutive frames report exactly what was drawn
+            if (frame.seq == last + 1)
+                EXPECT_TRUE(sameRect(frame.dirty, stream.rects[frame.seq]));
+            else if (frame.seq == last)
+                EXPECT_TRUE(rectEmpty(frame.dirty));
+            last = frame.seq;
+            pair.ring->release();
+
+            if (finished && last < kFrames) {
+                ADD_FAILURE() << "writer finished at " << kFrames << ", newest frame read " << last;
+                break;
+            }
+        }
+        writer.join();
+
+        EXPECT_EQ(0u, torn) << slots << " slots, " << acquired << " frames read";
+        EXPECT_EQ(0u, badDirty) << slots << " slots";
+        EXPECT_EQ(0u, badPts) << slots << " slots";
+    }
+}